@@ -0,0 +1,73 @@
+class AUS_BeltFeedComponentClass: ScriptComponentClass
+{
+}
+
+// Belt position of a weapon fed through an AUS_BeltMagazineWell.
+// The position is derived from the loaded magazine (rounds fed = capacity - ammo). The engine
+// already replicates the ammo count, so every machine reads the same position without
+// per-round state, extra replication or ammo event handlers to follow across gunners.
+class AUS_BeltFeedComponent : ScriptComponent
+{
+    private BaseMuzzleComponent m_Muzzle;
+    
+    //------------------------------------------------------------------------------------------------
+    override event protected void OnPostInit(IEntity owner)
+    {
+        super.OnPostInit(owner);
+        
+        m_Muzzle = BaseMuzzleComponent.Cast(owner.FindComponent(BaseMuzzleComponent));
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private BaseMagazineComponent GetMagazine()
+    {
+        if (!m_Muzzle)
+            return null;
+        
+        return m_Muzzle.GetMagazine();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Null when nothing is loaded or the magazine is not belt-fed
+    AUS_BeltMagazineWell GetBeltWell()
+    {
+        BaseMagazineComponent magazine = GetMagazine();
+        if (!magazine)
+            return null;
+        
+        return AUS_BeltMagazineWell.Cast(magazine.GetMagazineWell());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Rounds fed from the loaded belt
+    int GetBeltPosition()
+    {
+        BaseMagazineComponent magazine = GetMagazine();
+        if (!magazine)
+            return 0;
+        
+        return Math.Max(magazine.GetMaxAmmoCount() - magazine.GetAmmoCount(), 0);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Round offset rounds ahead of the next one to be fed
+    AUS_BeltRoundType GetRoundType(int offset = 0)
+    {
+        AUS_BeltMagazineWell well = GetBeltWell();
+        if (!well)
+            return AUS_BeltRoundType.BALL;
+        
+        return well.GetRoundType(GetBeltPosition() + offset);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Rounds of a type among the next count rounds, e.g. tracers left in the next burst
+    int CountNextRounds(AUS_BeltRoundType roundType, int count)
+    {
+        AUS_BeltMagazineWell well = GetBeltWell();
+        if (!well)
+            return 0;
+        
+        return well.CountRounds(roundType, GetBeltPosition(), count);
+    }
+}
@@ -1,15 +1,4 @@
-class AUS_MinigunBarrelControllerClass: ScriptGameComponentClass {}
-
-enum AUS_BarrelSpinState
-{
-    IDLE = 0,
-    SPIN_UP = 1,
-    READY_TO_FIRE = 2,
-    FIRING = 3,
-    SPIN_DOWN = 4
-}
-
-class AUS_MinigunBarrelController : ScriptGameComponent
+class AUS_MinigunBarrelControllerClass: ScriptGameComponentClass
 {
     // Configuration Attributes
     [Attribute("680", UIWidgets.EditBox, "Spin-up duration (ms)")]
@@ -36,34 +25,324 @@ class AUS_MinigunBarrelController : ScriptGameComponent
     [Attribute("1.5", UIWidgets.EditBox, "Spin-down curve exponent")]
     protected float m_fSpinDownCurve;
     
+    [Attribute("0", UIWidgets.EditBox, "Fixed state machine step (ms). 0 advances once per frame by the frame time.")]
+    protected int m_iFixedStep;
+    
+    [Attribute("0", UIWidgets.ComboBox, "State table of the weapon cycle, the durations and curves above apply to its states", "", ParamEnumArray.FromEnum(AUS_WeaponCycle))]
+    protected AUS_WeaponCycle m_eWeaponCycle;
+    
+    [Attribute("0", UIWidgets.ComboBox, "How firing intent is detected", "", ParamEnumArray.FromEnum(AUS_FireDetectionMode))]
+    protected AUS_FireDetectionMode m_eFireDetectionMode;
+    
+    [Attribute("TurretFire", UIWidgets.EditBox, "Input action read as the trigger for the seated local gunner (EVENTS detection or muzzle gate)")]
+    protected string m_sTriggerAction;
+    
+    [Attribute("0", UIWidgets.ComboBox, "How barrel state reaches remote clients", "", ParamEnumArray.FromEnum(AUS_BarrelReplicationMode))]
+    protected AUS_BarrelReplicationMode m_eReplicationMode;
+    
+    [Attribute("0", UIWidgets.ComboBox, "How spin speed reaches the animation graph and sound signals", "", ParamEnumArray.FromEnum(AUS_BarrelOutputMode))]
+    protected AUS_BarrelOutputMode m_eOutputMode;
+    
+    [Attribute("0.005", UIWidgets.EditBox, "Smallest spin speed change written to signals and animation, 0 and 1 are always written")]
+    protected float m_fSpinOutputEpsilon;
+    
+    [Attribute("1", UIWidgets.CheckBox, "Run the state machine predictively for the local gunner on clients (needs EVENTS detection and STATE replication)")]
+    protected bool m_bPredictLocalGunner;
+    
+    [Attribute("300", UIWidgets.EditBox, "Time after a trigger change during which the local prediction is trusted over the server state, until the round trip to the server has been measured (ms)")]
+    protected int m_iPredictionGrace;
+    
+    [Attribute("1", UIWidgets.CheckBox, "Hold the muzzle on its Safety fire mode until FIRING while a player's trigger drives the gun (needs a Safety fire mode)")]
+    protected bool m_bGateMuzzle;
+    
+    [Attribute("1", UIWidgets.CheckBox, "Group with the other minigun controllers on the same vehicle, sharing compartment events and distance checks")]
+    protected bool m_bShareAirframe;
+    
+    [Attribute("75", UIWidgets.EditBox, "LOD: guns closer to the camera than this always update every frame (m)")]
+    protected float m_fLodNearDistance;
+    
+    [Attribute("600", UIWidgets.EditBox, "LOD: guns further than this skip animation writes (m)")]
+    protected float m_fLodFarDistance;
+    
+    [Attribute("4", UIWidgets.EditBox, "LOD: frames between updates beyond the near distance")]
+    protected int m_iLodInterval;
+    
+    [Attribute("1", UIWidgets.CheckBox, "LOD: guns beyond the near distance and outside the camera view skip animation writes")]
+    protected bool m_bLodCullOffscreen;
+    
+    [Attribute("300", UIWidgets.EditBox, "Relevance (SIGNALS replication, server): signals are written every frame while a player is closer than this (m)")]
+    protected float m_fRelevanceNearDistance;
+    
+    [Attribute("1200", UIWidgets.EditBox, "Relevance (SIGNALS replication, server): no signal writes while every player is further than this, the audible range (m)")]
+    protected float m_fRelevanceFarDistance;
+    
+    [Attribute("4", UIWidgets.EditBox, "Relevance (SIGNALS replication, server): frames between signal writes while the nearest player is in between")]
+    protected int m_iRelevanceInterval;
+    
+    [Attribute("", UIWidgets.ResourcePickerThumbnail, "Continuous casing emitter, played at its authored birth rate while FIRING. Remote clients in SIGNALS replication follow the firing signal while the turret is manned.", "ptc")]
+    protected ResourceName m_sCasingEffect;
+    
+    [Attribute("", UIWidgets.EditBox, "Bone the casing effect is attached to, the weapon origin if empty")]
+    protected string m_sCasingBone;
+    
+    [Attribute("", UIWidgets.ResourcePickerThumbnail, "Continuous muzzle flash emitter, played at its authored birth rate while FIRING. Remote clients in SIGNALS replication follow the firing signal while the turret is manned.", "ptc")]
+    protected ResourceName m_sMuzzleFlashEffect;
+    
+    [Attribute("", UIWidgets.EditBox, "Bone the muzzle flash effect is attached to, the weapon origin if empty")]
+    protected string m_sMuzzleFlashBone;
+    
+    [Attribute("0", UIWidgets.EditBox, "Ticks kept in the state machine trace buffer, dumped on anomalies and by DumpTrace. 0 disables tracing.")]
+    protected int m_iTraceCapacity;
+    
+    private ref AUS_MinigunSpinProfile m_SpinProfile;
+    
+    //------------------------------------------------------------------------------------------------
+    // Built on first use and shared by every controller of this prefab
+    AUS_MinigunSpinProfile GetSpinProfile()
+    {
+        if (!m_SpinProfile)
+        {
+            m_SpinProfile = new AUS_MinigunSpinProfile(m_fSpinUpTime, m_fSpinDownTime, m_fFiringDelay, m_fMaxRPM, m_fFireDetectionTolerance, m_fTriggerDeadZone, m_fSpinUpCurve, m_fSpinDownCurve, m_iFixedStep, m_eWeaponCycle);
+            m_SpinProfile.SetLod(m_fLodNearDistance, m_fLodFarDistance, m_iLodInterval, m_bLodCullOffscreen);
+            m_SpinProfile.SetRelevance(m_fRelevanceNearDistance, m_fRelevanceFarDistance, m_iRelevanceInterval);
+        }
+        
+        return m_SpinProfile;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_FireDetectionMode GetFireDetectionMode()
+    {
+        return m_eFireDetectionMode;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    string GetTriggerAction()
+    {
+        return m_sTriggerAction;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_BarrelReplicationMode GetReplicationMode()
+    {
+        return m_eReplicationMode;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_BarrelOutputMode GetOutputMode()
+    {
+        return m_eOutputMode;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetSpinOutputEpsilon()
+    {
+        return m_fSpinOutputEpsilon;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Gated guns read the player gunner's trigger in any detection mode, a blocked muzzle never
+    // reports a shot. AI gunners stay ungated.
+    bool ShouldGateMuzzle()
+    {
+        return m_bGateMuzzle;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool ShouldShareAirframe()
+    {
+        return m_bShareAirframe;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True if the prefab is configured so that a client gunner can predict its own barrel state
+    bool CanPredictLocalGunner()
+    {
+        return m_bPredictLocalGunner && m_eFireDetectionMode == AUS_FireDetectionMode.EVENTS && m_eReplicationMode == AUS_BarrelReplicationMode.STATE;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetPredictionGrace()
+    {
+        return m_iPredictionGrace;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool HasFiringEffects()
+    {
+        return !m_sCasingEffect.IsEmpty() || !m_sMuzzleFlashEffect.IsEmpty();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_MinigunFiringEffects CreateFiringEffects(notnull IEntity owner)
+    {
+        return new AUS_MinigunFiringEffects(owner, m_sCasingEffect, m_sCasingBone, m_sMuzzleFlashEffect, m_sMuzzleFlashBone);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetTraceCapacity()
+    {
+        return m_iTraceCapacity;
+    }
+}
+
+enum AUS_BarrelSpinState
+{
+    IDLE = 0,
+    SPIN_UP = 1,
+    READY_TO_FIRE = 2,
+    FIRING = 3,
+    SPIN_DOWN = 4
+}
+
+// In TRANSITION mode the curve for the current state is sent once as start, target, duration (ms),
+// exponent and the time already elapsed (ms). With t = clamp(time / duration, 0, 1) consumers evaluate
+//   rising  (target > start): start + (target - start) * t^exponent
+//   falling (target < start): target + (start - target) * (1 - t)^exponent
+enum AUS_BarrelOutputMode
+{
+    PER_FRAME = 0,  // Spin speed written every tick while it changes
+    TRANSITION = 1  // Curve parameters written once per state transition
+}
+
+enum AUS_FireDetectionMode
+{
+    AMMO_POLL = 0,  // Poll the muzzle ammo count every tick, firing is inferred from consumed rounds.
+                    // Player gunners of a gated muzzle are driven by their trigger instead.
+    EVENTS = 1      // Trigger press/release from the gunner, ammo change events for gunners without input
+}
+
+enum AUS_BarrelReplicationMode
+{
+    SIGNALS = 0,    // Four MP signals streamed at 30 Hz
+    STATE = 1       // State and transition time, sent on change; clients rebuild spin locally
+}
+
+// Update rate of a controller, picked per frame by AUS_MinigunBarrelUpdater from the camera.
+// On the authority, e.g. a listen server host or single player, the state machine runs every frame
+// in any tier and only the outputs follow it.
+enum AUS_BarrelLodTier
+{
+    FULL = 0,       // State machine and all outputs every frame
+    REDUCED = 1,    // State machine and all outputs every LOD interval
+    CULLED = 2      // State machine and signals every LOD interval, no animation writes
+}
+
+// Network relevance of a controller on the authority, picked per frame by AUS_MinigunBarrelUpdater
+// from the nearest player. The state machine, muzzle gate and reload lock always run at full rate.
+enum AUS_BarrelRelevanceTier
+{
+    FULL = 0,       // Signals written every frame
+    REDUCED = 1,    // Signals written on state changes and every relevance interval
+    CULLED = 2      // No signal writes until a player comes in range or the gun goes to sleep
+}
+
+class AUS_MinigunBarrelController : ScriptGameComponent
+{
     // Component References
     private SignalsManagerComponent m_SignalsManager;
     private BaseMuzzleComponent m_Muzzle;
     private AUS_WeaponAnimationComponent m_AnimationComponent;
     private BaseWeaponComponent m_WeaponComponent;
+    private ref AUS_MinigunWeaponGate m_WeaponGate;
+    
+    // Continuous firing effects, client side only, null unless the prefab sets an effect
+    private ref AUS_MinigunFiringEffects m_FiringEffects;
+    
+    // Shared Tuning
+    private AUS_MinigunSpinProfile m_SpinProfile;
+    private AUS_BarrelReplicationMode m_eReplicationMode;
+    private AUS_BarrelOutputMode m_eOutputMode;
+    private AUS_FireDetectionMode m_eFireDetectionMode;
+    private string m_sTriggerAction;
+    
+    // Trigger Input (EVENTS detection or muzzle gate)
+    private bool m_bTriggerHeld = false;
+    private bool m_bTriggerDriven = false;
+    private bool m_bGunnerTrigger = false;
+    private bool m_bShotPending = false;
+    private bool m_bListenForTrigger = false;
+    private bool m_bListeningForTrigger = false;
     
-    // State Management
-    private AUS_BarrelSpinState m_eCurrentState = AUS_BarrelSpinState.IDLE;
-    private float m_fStateTimer = 0.0;
-    private float m_fCurrentSpinSpeed = 0.0;
-    private float m_fLastFireTime = -1000.0;
-    private float m_fLastStateChangeTime = -1000.0;
+    // SIGNALS proxy of the local gunner or with firing effects, its gate, reload lock and effects
+    // follow the replicated signals
+    private bool m_bFollowingSignals = false;
+    
+    // Replication
+    private RplComponent m_RplComponent;
+    private bool m_bAuthority = true;
+    private bool m_bRemoteProxy = false;
+    private bool m_bSignalsProxy = false;
+    
+    [RplProp(onRplName: "OnRplBarrelStateChanged")]
+    private int m_iRplState = AUS_BarrelSpinState.IDLE;
+    
+    [RplProp(onRplName: "OnRplBarrelStateChanged")]
+    private WorldTimestamp m_RplTransitionTime;
+    
+    // Join-in-progress snapshot, written once into the late joiner's payload by RplSave.
+    // Timers are clamped to SNAPSHOT_MAX_TIME, which is longer than any state lasts.
+    private static const int SNAPSHOT_MAX_TIME = 65535;
+    private bool m_bHasSnapshot = false;
+    private bool m_bPostInitDone = false;
+    private AUS_BarrelSpinState m_eSnapshotState;
+    private int m_iSnapshotTimer;
+    private float m_fSnapshotSpin;
+    private int m_iSnapshotSinceFire;
+    
+    // Prediction (local gunner on a client)
+    private bool m_bCanPredict = false;
+    private bool m_bPredicting = false;
+    private bool m_bPredictionCheckPending = false;
+    private bool m_bRolledBack = false;
+    private int m_iPredictionGrace;
+    
+    // Round trip of a trigger press to the server and back (ms), smoothed. -1 until the first
+    // sample, the prefab's grace applies until then.
+    private static const float ROUND_TRIP_SMOOTHING = 0.25;
+    private static const float GRACE_ROUND_TRIPS = 1.5;
+    private static const int GRACE_MARGIN = 50;
+    private float m_fRoundTrip = -1;
+    private WorldTimestamp m_TriggerSentTime;
+    private bool m_bRoundTripPending = false;
+    
+    // State Management (hot state lives in the AUS_MinigunBarrelUpdater while awake)
+    private AUS_MinigunBarrelUpdater m_Updater;
+    private bool m_bComponentTicked = false;
+    private int m_iSlot = -1;
     private int m_iPreviousAmmoCount = 0;
-    private bool m_bWasFiring = false;
+    private int m_iLastAmmoDelta = 0;
     private bool m_bReloadLocked = false;
     
-    // Simplified State Gating Variables
-    private bool m_bForceSpinDown = false;
-    private bool m_bSpinUpComplete = false;
+    // Tracing, null unless the prefab sets a trace capacity
+    private ref AUS_MinigunTraceRecorder m_TraceRecorder;
     
     // Weapon Firing Control
     private bool m_bWeaponFiringBlocked = false;
     
+    // Sleep/Wake
+    private EventHandlerManagerComponent m_WeaponEventHandler;
+    private EventHandlerManagerComponent m_VehicleEventHandler;
+    private EventHandlerManagerComponent m_GunnerEventHandler;
+    private IEntity m_Gunner;
+    
+    // Vehicle the compartment events come from, null until the weapon is mounted
+    private IEntity m_Vehicle;
+    
+    // Shared vehicle handle, owned by the system. Null when not mounted or not grouped.
+    private AUS_MinigunAirframeGroup m_AirframeGroup;
+    private bool m_bShareAirframe = false;
+    
     // Signal IDs
     private int m_iBarrelSpinSignal = -1;
     private int m_iSpinUpActiveSignal = -1;
     private int m_iSpinDownActiveSignal = -1;
     private int m_iFiringActiveSignal = -1;
+    private int m_iSpinStartSignal = -1;
+    private int m_iSpinTargetSignal = -1;
+    private int m_iSpinDurationSignal = -1;
+    private int m_iSpinCurveSignal = -1;
+    private int m_iSpinElapsedSignal = -1;
     
     // Animation Variable IDs
     private int m_iBarrelSpinSpeedVar = -1;
@@ -71,6 +350,40 @@ class AUS_MinigunBarrelController : ScriptGameComponent
     private int m_iFiringVar = -1;
     private int m_iVehicleFireReleasedVar = -1;
     
+    // Transition mode curve variables, float indices into m_TransitionVariables
+    private static const int TRANSITION_VAR_START = 0;
+    private static const int TRANSITION_VAR_TARGET = 1;
+    private static const int TRANSITION_VAR_DURATION = 2;
+    private static const int TRANSITION_VAR_CURVE = 3;
+    private static const int TRANSITION_VAR_ELAPSED = 4;
+    private static const int TRANSITION_VAR_COUNT = 5;
+    private ref AUS_AnimationVariableSet m_TransitionVariables;
+    
+    // Last Written Outputs (-1 forces the first write)
+    private float m_fSpinOutputEpsilon;
+    private float m_fSentSpinSignal = -1;
+    private float m_fSentSpinUpSignal = -1;
+    private float m_fSentFiringSignal = -1;
+    private float m_fSentSpinDownSignal = -1;
+    private float m_fSentSpinVar = -1;
+    private int m_iSentStateVar = -1;
+    private int m_iSentFiringVar = -1;
+    private int m_iSentFireReleasedVar = -1;
+    
+    // Output Write Counters
+    private int m_iOutputWritesIssued = 0;
+    private int m_iOutputWritesSkipped = 0;
+    private static int s_iOutputWritesIssued = 0;
+    private static int s_iOutputWritesSkipped = 0;
+    
+    // Profiler counters, created on first use while AUS_MinigunProfiler is enabled
+    private AUS_MinigunControllerStats m_ProfilerStats;
+    
+    // Replication Estimate (payload bytes only, no headers)
+    private static const int RPL_STATE_BYTES = 9;
+    private int m_iReplicationUpdates = 0;
+    private int m_iReplicatedBytesEstimate = 0;
+    
     //------------------------------------------------------------------------------------------------
     override event protected void OnPostInit(IEntity owner)
     {
@@ -85,379 +398,1349 @@ class AUS_MinigunBarrelController : ScriptGameComponent
         if (!m_SignalsManager || !m_Muzzle)
             return;
         
-        InitializeSignals();
-        InitializeAnimationVariables();
+        AUS_MinigunBarrelControllerClass prefabData = AUS_MinigunBarrelControllerClass.Cast(GetComponentData(owner));
+        if (!prefabData)
+            return;
+        
+        m_SpinProfile = prefabData.GetSpinProfile();
+        m_eReplicationMode = prefabData.GetReplicationMode();
+        m_eOutputMode = prefabData.GetOutputMode();
+        m_eFireDetectionMode = prefabData.GetFireDetectionMode();
+        m_sTriggerAction = prefabData.GetTriggerAction();
+        m_iPredictionGrace = prefabData.GetPredictionGrace();
+        m_fSpinOutputEpsilon = prefabData.GetSpinOutputEpsilon();
+        m_bShareAirframe = prefabData.ShouldShareAirframe();
+        
+        m_RplComponent = RplComponent.Cast(owner.FindComponent(RplComponent));
+        if (m_RplComponent)
+        {
+            m_bAuthority = m_RplComponent.Role() == RplRole.Authority;
+            m_bRemoteProxy = m_RplComponent.IsProxy() && !m_RplComponent.IsOwner();
+        }
+        
+        // In SIGNALS mode remote proxies are driven by the replicated signals only, apart from the
+        // join-in-progress snapshot. They still follow the gunner, whose trigger goes to the server.
+        m_bSignalsProxy = m_bRemoteProxy && m_eReplicationMode == AUS_BarrelReplicationMode.SIGNALS;
+        m_bCanPredict = !m_bAuthority && prefabData.CanPredictLocalGunner();
+        
+        // The authority and the gunner's own client hold the muzzle. A SIGNALS proxy has no state
+        // machine and opens it from the replicated firing signal.
+        if (prefabData.ShouldGateMuzzle())
+        {
+            m_WeaponGate = new AUS_MinigunWeaponGate(m_Muzzle);
+            if (!m_WeaponGate.IsAvailable())
+            {
+                Print("[AUS_MinigunBarrelController] Muzzle has no Safety fire mode, firing is not gated by spin-up", LogLevel.WARNING);
+                m_WeaponGate = null;
+            }
+        }
+        
+        // The server's gate waits for the trigger whatever the client's replication mode
+        m_bListenForTrigger = m_eFireDetectionMode == AUS_FireDetectionMode.EVENTS || prefabData.ShouldGateMuzzle();
+        
+        // Without the system in the world's config, awake controllers tick the shared fallback updater
+        m_Updater = AUS_MinigunBarrelSystem.GetUpdater(owner.GetWorld());
+        m_bComponentTicked = m_Updater.IsComponentTicked();
+        
+        if (prefabData.HasFiringEffects() && RplSession.Mode() != RplMode.Dedicated)
+            m_FiringEffects = prefabData.CreateFiringEffects(owner);
+        
+        if (!m_bSignalsProxy)
+        {
+            InitializeSignals();
+            InitializeAnimationVariables();
+            
+            if (prefabData.GetTraceCapacity() > 0)
+                m_TraceRecorder = new AUS_MinigunTraceRecorder(m_SpinProfile, prefabData.GetTraceCapacity());
+        }
         
         // Set initial state
         m_iPreviousAmmoCount = m_Muzzle.GetAmmoCount();
-        m_fLastFireTime = System.GetTickCount();
-        m_fLastStateChangeTime = System.GetTickCount();
         
         // Start with weapon firing blocked
         m_bWeaponFiringBlocked = true;
         
+        RegisterWakeEvents(owner);
+        
         Print("[AUS_MinigunBarrelController] Component initialized successfully", LogLevel.NORMAL);
-        SetEventMask(owner, EntityEvent.FRAME);
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void InitializeSignals()
-    {
-        if (!m_SignalsManager)
-            return;
-            
-        m_iBarrelSpinSignal = m_SignalsManager.AddOrFindMPSignal("AUS_BarrelSpin", 0.1, 1.0/30.0, 0, SignalCompressionFunc.Range01);
-        m_iSpinUpActiveSignal = m_SignalsManager.AddOrFindMPSignal("AUS_SpinUpActive", 0.1, 1.0/30.0, 0, SignalCompressionFunc.Range01);
-        m_iSpinDownActiveSignal = m_SignalsManager.AddOrFindMPSignal("AUS_SpinDownActive", 0.1, 1.0/30.0, 0, SignalCompressionFunc.Range01);
-        m_iFiringActiveSignal = m_SignalsManager.AddOrFindMPSignal("AUS_FiringActive", 0.1, 1.0/30.0, 0, SignalCompressionFunc.Range01);
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void InitializeAnimationVariables()
-    {
-        if (!m_AnimationComponent)
-            return;
-            
-        m_iBarrelSpinSpeedVar = m_AnimationComponent.BindVariableFloat("BarrelSpinSpeed");
-        m_iSpinStateVar = m_AnimationComponent.BindVariableInt("SpinState");
-        m_iFiringVar = m_AnimationComponent.BindVariableBool("Firing");
-        m_iVehicleFireReleasedVar = m_AnimationComponent.BindVariableBool("VehicleFireReleased");
+        
+        m_bPostInitDone = true;
+        
+        // Tick once so the outputs settle, then sleep until something wakes us
+        if (m_bHasSnapshot)
+            ApplySnapshot();
+        else if (m_bRemoteProxy)
+            OnRplBarrelStateChanged();
+        else
+            Wake();
     }
     
     //------------------------------------------------------------------------------------------------
-    override event protected bool OnTicksOnRemoteProxy()
+    // About 43 bits: state, state timer, spin speed and time since the last shot
+    override bool RplSave(ScriptBitWriter writer)
     {
-        return false;
+        AUS_BarrelSpinState state = AUS_BarrelSpinState.IDLE;
+        int stateTimer = 0;
+        float spinSpeed = 0;
+        int sinceFire = SNAPSHOT_MAX_TIME;
+        
+        if (m_iSlot != -1)
+        {
+            state = m_Updater.GetState(m_iSlot);
+            stateTimer = m_Updater.GetStateTimer(m_iSlot);
+            stateTimer = Math.ClampInt(stateTimer, 0, SNAPSHOT_MAX_TIME);
+            spinSpeed = m_Updater.GetSpinSpeed(m_iSlot);
+            sinceFire = Math.ClampInt(m_Updater.GetTimeSinceFire(m_iSlot), 0, SNAPSHOT_MAX_TIME);
+        }
+        
+        writer.WriteIntRange(state, 0, AUS_BarrelSpinState.SPIN_DOWN);
+        writer.WriteIntRange(stateTimer, 0, SNAPSHOT_MAX_TIME);
+        writer.WriteIntRange(Math.Round(spinSpeed * 255), 0, 255);
+        writer.WriteIntRange(sinceFire, 0, SNAPSHOT_MAX_TIME);
+        return true;
     }
     
     //------------------------------------------------------------------------------------------------
-    override event protected void EOnFrame(IEntity owner, float timeSlice)
+    override bool RplLoad(ScriptBitReader reader)
     {
-        super.EOnFrame(owner, timeSlice);
+        int state, stateTimer, spin, sinceFire;
+        if (!reader.ReadIntRange(state, 0, AUS_BarrelSpinState.SPIN_DOWN))
+            return false;
         
-        if (!m_Muzzle || !m_SignalsManager)
-            return;
-            
-        float currentTime = System.GetTickCount();
+        if (!reader.ReadIntRange(stateTimer, 0, SNAPSHOT_MAX_TIME))
+            return false;
         
-        // Detect firing state based on barrel state, not ammo consumption
-        bool isFiring = DetectFiringIntent(currentTime);
+        if (!reader.ReadIntRange(spin, 0, 255))
+            return false;
         
-        // Update state machine with firing delay
-        UpdateStateMachineWithFiringDelay(isFiring, currentTime, timeSlice);
+        if (!reader.ReadIntRange(sinceFire, 0, SNAPSHOT_MAX_TIME))
+            return false;
         
-        // Calculate current spin speed
-        CalculateSpinSpeed(timeSlice);
+        m_eSnapshotState = state;
+        m_iSnapshotTimer = stateTimer;
+        m_fSnapshotSpin = spin / 255.0;
+        m_iSnapshotSinceFire = sinceFire;
+        m_bHasSnapshot = true;
         
-        // Update outputs
-        UpdateOutputs();
+        if (m_bPostInitDone)
+            ApplySnapshot();
         
-        // Handle reload and weapon firing control
-        UpdateReloadLock();
-        UpdateWeaponFiringControl();
+        return true;
     }
     
     //------------------------------------------------------------------------------------------------
-    private bool DetectFiringIntent(float currentTime)
+    // Restores the authority's state on a late joiner. STATE proxies resume the replicated slot from
+    // it, SIGNALS proxies write their outputs once and leave the rest to the signal stream.
+    private void ApplySnapshot()
     {
-        // For now, use the same ammo-based detection
-        // Later we can modify this to use trigger input instead
-        int currentAmmoCount = m_Muzzle.GetAmmoCount();
-        int deltaAmmo = currentAmmoCount - m_iPreviousAmmoCount;
+        m_bHasSnapshot = false;
         
-        bool firingDetected = deltaAmmo < 0;
+        if (m_bAuthority || !m_SpinProfile)
+            return;
         
-        if (firingDetected)
+        if (m_eReplicationMode == AUS_BarrelReplicationMode.SIGNALS)
         {
-            m_fLastFireTime = currentTime;
+            InitializeSignals();
+            InitializeAnimationVariables();
+            ApplyState(m_eSnapshotState, m_fSnapshotSpin, m_iSnapshotTimer);
+            return;
         }
         
-        bool isFiring = firingDetected || (currentTime - m_fLastFireTime) < m_fFireDetectionTolerance;
-        
-        m_iPreviousAmmoCount = currentAmmoCount;
+        if (!m_Updater)
+            return;
         
-        return isFiring;
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void UpdateStateMachineWithFiringDelay(bool isFiring, float currentTime, float timeSlice)
-    {
-        bool inDeadZone = (currentTime - m_fLastStateChangeTime) < m_fTriggerDeadZone;
-        
-        switch (m_eCurrentState)
-        {
-            case AUS_BarrelSpinState.IDLE:
-                if (isFiring)
-                {
-                    StartSpinUp(currentTime);
-                }
-                break;
-                
-            case AUS_BarrelSpinState.SPIN_UP:
-                if (m_fStateTimer >= m_fSpinUpTime)
-                {
-                    m_bSpinUpComplete = true;
-                }
-                
-                if (m_bSpinUpComplete)
-                {
-                    if (isFiring)
-                    {
-                        EnterReadyToFireState(currentTime);
-                    }
-                    else if (m_bForceSpinDown)
-                    {
-                        StartSpinDown(currentTime);
-                    }
-                    else if (!isFiring)
-                    {
-                        StartSpinDown(currentTime);
-                    }
-                }
-                else if (!isFiring && !inDeadZone)
-                {
-                    m_bForceSpinDown = true;
-                }
-                break;
-                
-            case AUS_BarrelSpinState.READY_TO_FIRE:
-                if (m_fStateTimer >= m_fFiringDelay)
-                {
-                    if (isFiring)
-                    {
-                        EnterFiringState(currentTime);
-                    }
-                    else
-                    {
-                        StartSpinDown(currentTime);
-                    }
-                }
-                else if (!isFiring && !inDeadZone)
-                {
-                    StartSpinDown(currentTime);
-                }
-                break;
-                
-            case AUS_BarrelSpinState.FIRING:
-                if (!isFiring)
-                {
-                    StartSpinDown(currentTime);
-                }
-                break;
-                
-            case AUS_BarrelSpinState.SPIN_DOWN:
-                if (m_fStateTimer >= m_fSpinDownTime)
-                {
-                    ReturnToIdle(currentTime);
-                }
-                else if (isFiring && !inDeadZone)
-                {
-                    StartSpinUp(currentTime);
-                }
-                break;
-        }
-        
-        m_fStateTimer += timeSlice * 1000.0;
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void StartSpinUp(float currentTime)
-    {
-        m_eCurrentState = AUS_BarrelSpinState.SPIN_UP;
-        m_fStateTimer = 0.0;
-        m_fLastStateChangeTime = currentTime;
-        m_bWasFiring = false;
-        m_bSpinUpComplete = false;
-        m_bForceSpinDown = false;
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void EnterReadyToFireState(float currentTime)
-    {
-        m_eCurrentState = AUS_BarrelSpinState.READY_TO_FIRE;
-        m_fStateTimer = 0.0;
-        m_fLastStateChangeTime = currentTime;
-        m_bSpinUpComplete = false;
-        m_bForceSpinDown = false;
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void EnterFiringState(float currentTime)
-    {
-        m_eCurrentState = AUS_BarrelSpinState.FIRING;
-        m_fStateTimer = 0.0;
-        m_fLastStateChangeTime = currentTime;
-        m_bWasFiring = true;
-        m_bSpinUpComplete = false;
-        m_bForceSpinDown = false;
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void StartSpinDown(float currentTime)
-    {
-        m_eCurrentState = AUS_BarrelSpinState.SPIN_DOWN;
-        m_fStateTimer = 0.0;
-        m_fLastStateChangeTime = currentTime;
-        m_bSpinUpComplete = false;
-        m_bForceSpinDown = false;
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void ReturnToIdle(float currentTime)
-    {
-        m_eCurrentState = AUS_BarrelSpinState.IDLE;
-        m_fStateTimer = 0.0;
-        m_fLastStateChangeTime = currentTime;
-        m_fCurrentSpinSpeed = 0.0;
-        m_bWasFiring = false;
-        m_bSpinUpComplete = false;
-        m_bForceSpinDown = false;
-    }
-    
-    //------------------------------------------------------------------------------------------------
-    private void CalculateSpinSpeed(float timeSlice)
-    {
-        switch (m_eCurrentState)
-        {
-            case AUS_BarrelSpinState.IDLE:
-                m_fCurrentSpinSpeed = 0.0;
-                break;
-                
-            case AUS_BarrelSpinState.SPIN_UP:
-                {
-                    float progress = Math.Clamp(m_fStateTimer / m_fSpinUpTime, 0.0, 1.0);
-                    m_fCurrentSpinSpeed = Math.Pow(progress, m_fSpinUpCurve);
-                }
-                break;
-                
-            case AUS_BarrelSpinState.READY_TO_FIRE:
-                m_fCurrentSpinSpeed = 1.0;
-                break;
-                
-            case AUS_BarrelSpinState.FIRING:
-                m_fCurrentSpinSpeed = 1.0;
-                break;
-                
-            case AUS_BarrelSpinState.SPIN_DOWN:
-                {
-                    float progress = Math.Clamp(m_fStateTimer / m_fSpinDownTime, 0.0, 1.0);
-                    m_fCurrentSpinSpeed = Math.Pow(1.0 - progress, m_fSpinDownCurve);
-                }
-                break;
-        }
+        Wake();
+        m_Updater.SetReplicatedState(m_iSlot, m_eSnapshotState, m_iSnapshotTimer);
+        m_Updater.SetTimeSinceFire(m_iSlot, m_iSnapshotSinceFire);
     }
     
     //------------------------------------------------------------------------------------------------
-    private void UpdateOutputs()
+    override event protected void OnDelete(IEntity owner)
     {
-        if (!m_SignalsManager)
-            return;
-            
-        m_SignalsManager.SetSignalValue(m_iBarrelSpinSignal, m_fCurrentSpinSpeed);
-        
-        int spinUpActive = 0;
-        int firingActive = 0;
-        int spinDownActive = 0;
-        
-        if (m_eCurrentState == AUS_BarrelSpinState.SPIN_UP)
-            spinUpActive = 1;
-        else if (m_eCurrentState == AUS_BarrelSpinState.FIRING)
-            firingActive = 1;
-        else if (m_eCurrentState == AUS_BarrelSpinState.SPIN_DOWN)
-            spinDownActive = 1;
+        GetGame().GetCallqueue().Remove(CheckPrediction);
+        UnregisterWakeEvents();
+        Sleep();
+        m_FiringEffects = null;
         
-        m_SignalsManager.SetSignalValue(m_iSpinUpActiveSignal, spinUpActive);
-        m_SignalsManager.SetSignalValue(m_iFiringActiveSignal, firingActive);
-        m_SignalsManager.SetSignalValue(m_iSpinDownActiveSignal, spinDownActive);
+        super.OnDelete(owner);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Vehicle events are registered a frame later, a slot-spawned weapon is only attached to its
+    // vehicle after its own init
+    private void RegisterWakeEvents(IEntity owner)
+    {
+        m_WeaponEventHandler = EventHandlerManagerComponent.Cast(owner.FindComponent(EventHandlerManagerComponent));
+        if (m_WeaponEventHandler)
+            m_WeaponEventHandler.RegisterScriptHandler("OnAmmoCountChanged", this, OnAmmoCountChanged);
         
-        if (m_AnimationComponent && m_eCurrentState != AUS_BarrelSpinState.IDLE)
-        {
-            m_AnimationComponent.SetVariableFloat(m_iBarrelSpinSpeedVar, m_fCurrentSpinSpeed);
-            m_AnimationComponent.SetVariableInt(m_iSpinStateVar, m_eCurrentState);
-            
-            bool firingState = false;
-            if (m_eCurrentState == AUS_BarrelSpinState.FIRING)
-                firingState = true;
-            m_AnimationComponent.SetVariableBool(m_iFiringVar, firingState);
-            
-            bool vehicleFireReleased = false;
-            if (m_eCurrentState == AUS_BarrelSpinState.SPIN_DOWN)
-                vehicleFireReleased = true;
-            m_AnimationComponent.SetVariableBool(m_iVehicleFireReleasedVar, vehicleFireReleased);
-        }
+        GetGame().GetCallqueue().CallLater(RegisterVehicleEvents);
     }
     
     //------------------------------------------------------------------------------------------------
-    private void UpdateReloadLock()
+    // Mounting the weapon later, or on another vehicle, moves the compartment events along
+    override event protected void OnAddedToParent(IEntity child, IEntity parent)
     {
-        bool shouldLockReload = (m_eCurrentState != AUS_BarrelSpinState.IDLE);
+        super.OnAddedToParent(child, parent);
         
-        if (shouldLockReload != m_bReloadLocked)
-        {
-            m_bReloadLocked = shouldLockReload;
-        }
+        if (!m_bPostInitDone || !m_Updater)
+            return;
+        
+        ScriptCallQueue callQueue = GetGame().GetCallqueue();
+        callQueue.Remove(RegisterVehicleEvents);
+        callQueue.CallLater(RegisterVehicleEvents);
     }
     
     //------------------------------------------------------------------------------------------------
-    private void UpdateWeaponFiringControl()
+    private void RegisterVehicleEvents()
     {
-        bool shouldAllowFiring = (m_eCurrentState == AUS_BarrelSpinState.FIRING);
+        IEntity owner = GetOwner();
+        IEntity vehicle = owner.GetRootParent();
+        if (vehicle == owner)
+            vehicle = null;
         
-        if (shouldAllowFiring != !m_bWeaponFiringBlocked)
+        if (vehicle == m_Vehicle)
+            return;
+        
+        UnregisterVehicleEvents();
+        m_Vehicle = vehicle;
+        if (!m_Vehicle)
+            return;
+        
+        // The group forwards the vehicle's compartment events
+        if (m_bShareAirframe)
         {
-            if (shouldAllowFiring)
-            {
-                m_bWeaponFiringBlocked = false;
-            }
-            else
+            m_AirframeGroup = m_Updater.JoinAirframeGroup(this, m_Vehicle);
+            if (m_iSlot != -1)
+                m_Updater.SetAirframeGroup(m_iSlot, m_AirframeGroup);
+        }
+        else
+        {
+            m_VehicleEventHandler = EventHandlerManagerComponent.Cast(m_Vehicle.FindComponent(EventHandlerManagerComponent));
+            if (m_VehicleEventHandler)
             {
-                m_bWeaponFiringBlocked = true;
+                m_VehicleEventHandler.RegisterScriptHandler("OnCompartmentEntered", this, OnCompartmentEntered);
+                m_VehicleEventHandler.RegisterScriptHandler("OnCompartmentLeft", this, OnCompartmentLeft);
             }
         }
+        
+        // A gunner seated before the events were registered, e.g. after join-in-progress or a weapon respawn
+        IEntity gunner = FindSeatedGunner();
+        if (gunner)
+            OnGunnerEntered(gunner);
     }
     
     //------------------------------------------------------------------------------------------------
-    AUS_BarrelSpinState GetCurrentState()
+    private void UnregisterVehicleEvents()
     {
-        return m_eCurrentState;
+        if (m_VehicleEventHandler)
+        {
+            m_VehicleEventHandler.RemoveScriptHandler("OnCompartmentEntered", this, OnCompartmentEntered);
+            m_VehicleEventHandler.RemoveScriptHandler("OnCompartmentLeft", this, OnCompartmentLeft);
+            m_VehicleEventHandler = null;
+        }
+        
+        if (m_AirframeGroup)
+        {
+            m_Updater.LeaveAirframeGroup(this, m_AirframeGroup);
+            m_AirframeGroup = null;
+            if (m_iSlot != -1)
+                m_Updater.SetAirframeGroup(m_iSlot, null);
+        }
+        
+        m_Vehicle = null;
     }
     
     //------------------------------------------------------------------------------------------------
-    float GetCurrentSpinSpeed()
+    private void UnregisterWakeEvents()
     {
-        return m_fCurrentSpinSpeed;
+        GetGame().GetCallqueue().Remove(RegisterVehicleEvents);
+        
+        if (m_WeaponEventHandler)
+            m_WeaponEventHandler.RemoveScriptHandler("OnAmmoCountChanged", this, OnAmmoCountChanged);
+        
+        UnregisterVehicleEvents();
+        SetGunnerEventHandler(null);
+        SetListeningForTrigger(false);
     }
     
     //------------------------------------------------------------------------------------------------
-    bool IsReloadLocked()
+    // Shots are reported on the gunner's event handler, so follow whoever is seated
+    private void SetGunnerEventHandler(EventHandlerManagerComponent gunnerEventHandler)
     {
-        return m_bReloadLocked;
+        if (m_GunnerEventHandler == gunnerEventHandler)
+            return;
+        
+        if (m_GunnerEventHandler)
+        {
+            m_GunnerEventHandler.RemoveScriptHandler("OnProjectileShot", this, OnProjectileShot);
+            m_GunnerEventHandler.RemoveScriptHandler("OnAmmoCountChanged", this, OnAmmoCountChanged);
+        }
+        
+        m_GunnerEventHandler = gunnerEventHandler;
+        
+        if (m_GunnerEventHandler)
+        {
+            m_GunnerEventHandler.RegisterScriptHandler("OnProjectileShot", this, OnProjectileShot);
+            m_GunnerEventHandler.RegisterScriptHandler("OnAmmoCountChanged", this, OnAmmoCountChanged);
+        }
     }
     
     //------------------------------------------------------------------------------------------------
-    bool CanWeaponFire()
+    // Called by the vehicle's event handler, or by the airframe group
+    void OnCompartmentEntered(IEntity vehicle, BaseCompartmentManagerComponent manager, IEntity occupant, int managerId, int slotId)
     {
-        return !m_bWeaponFiringBlocked && (m_eCurrentState == AUS_BarrelSpinState.FIRING);
+        if (IsGunnerCompartment(manager, slotId))
+            OnGunnerEntered(occupant);
     }
     
     //------------------------------------------------------------------------------------------------
-    float GetStateProgress()
+    private void OnGunnerEntered(IEntity occupant)
+    {
+        if (occupant)
+        {
+            m_Gunner = occupant;
+            SetGunnerEventHandler(EventHandlerManagerComponent.Cast(occupant.FindComponent(EventHandlerManagerComponent)));
+            
+            // A player gunner drives the gun by trigger from the moment they sit down, so the gate
+            // holds the muzzle before their first press reaches this machine. Their client fires
+            // locally as well and is held the same way, other clients are left alone.
+            bool localGunner = occupant == SCR_PlayerController.GetLocalControlledEntity();
+            if (m_WeaponGate && (m_bAuthority || localGunner) && GetGame().GetPlayerManager().GetPlayerIdFromControlledEntity(occupant) != 0)
+            {
+                m_bTriggerDriven = true;
+                UpdateWeaponFiringControl(GetCurrentState());
+            }
+            
+            if (m_bListenForTrigger && localGunner)
+            {
+                SetListeningForTrigger(true);
+                SetPredicting(m_bCanPredict);
+            }
+        }
+        
+        UpdateSignalFollowing();
+        Wake();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void OnCompartmentLeft(IEntity vehicle, BaseCompartmentManagerComponent manager, IEntity occupant, int managerId, int slotId)
+    {
+        if (!IsGunnerCompartment(manager, slotId))
+            return;
+        
+        SetGunnerEventHandler(null);
+        m_Gunner = null;
+        
+        if (m_bListeningForTrigger && occupant == SCR_PlayerController.GetLocalControlledEntity())
+        {
+            SetListeningForTrigger(false);
+            SetPredicting(false);
+        }
+        
+        // A gunner who dismounts, dies or disconnects while firing never sends the release
+        m_bGunnerTrigger = false;
+        if (m_bTriggerHeld)
+            SetTriggerHeld(false);
+        
+        // The next gunner may be an AI without trigger input
+        m_bTriggerDriven = false;
+        UpdateWeaponFiringControl(GetCurrentState());
+        UpdateSignalFollowing();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True if the compartment belongs to the turret this weapon is mounted on
+    private bool IsGunnerCompartment(BaseCompartmentManagerComponent manager, int slotId)
+    {
+        if (!manager)
+            return false;
+        
+        BaseCompartmentSlot slot = manager.FindCompartment(slotId);
+        if (!slot || !TurretCompartmentSlot.Cast(slot))
+            return false;
+        
+        IEntity slotOwner = slot.GetOwner();
+        IEntity owner = GetOwner();
+        return slotOwner == owner || slotOwner == owner.GetParent();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Occupant of the turret compartment this weapon is mounted on, null if it is empty
+    private IEntity FindSeatedGunner()
+    {
+        IEntity owner = GetOwner();
+        IEntity gunner = FindTurretOccupant(owner);
+        if (!gunner && owner.GetParent())
+            gunner = FindTurretOccupant(owner.GetParent());
+        
+        return gunner;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static IEntity FindTurretOccupant(notnull IEntity turret)
+    {
+        BaseCompartmentManagerComponent manager = BaseCompartmentManagerComponent.Cast(turret.FindComponent(BaseCompartmentManagerComponent));
+        if (!manager)
+            return null;
+        
+        array<BaseCompartmentSlot> compartments = {};
+        manager.GetCompartments(compartments);
+        foreach (BaseCompartmentSlot compartment : compartments)
+        {
+            if (TurretCompartmentSlot.Cast(compartment) && compartment.GetOwner() == turret && compartment.GetOccupant())
+                return compartment.GetOccupant();
+        }
+        
+        return null;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void OnProjectileShot(int playerId, BaseWeaponComponent weapon, IEntity entity)
+    {
+        if (weapon == m_WeaponComponent)
+            Wake();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void OnAmmoCountChanged(BaseWeaponComponent weapon, BaseMuzzleComponent muzzle, BaseMagazineComponent magazine, int ammoCount, bool isBarrelChambered)
+    {
+        if (muzzle != m_Muzzle && weapon != m_WeaponComponent)
+            return;
+        
+        if (m_eFireDetectionMode == AUS_FireDetectionMode.EVENTS)
+        {
+            if (ammoCount < m_iPreviousAmmoCount)
+                m_bShotPending = true;
+            
+            m_iPreviousAmmoCount = ammoCount;
+        }
+        
+        Wake();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void SetListeningForTrigger(bool listen)
+    {
+        if (m_bListeningForTrigger == listen)
+            return;
+        
+        InputManager inputManager = GetGame().GetInputManager();
+        if (!inputManager)
+            return;
+        
+        m_bListeningForTrigger = listen;
+        
+        if (listen)
+        {
+            inputManager.AddActionListener(m_sTriggerAction, EActionTrigger.DOWN, OnTriggerPressed);
+            inputManager.AddActionListener(m_sTriggerAction, EActionTrigger.UP, OnTriggerReleased);
+        }
+        else
+        {
+            inputManager.RemoveActionListener(m_sTriggerAction, EActionTrigger.DOWN, OnTriggerPressed);
+            inputManager.RemoveActionListener(m_sTriggerAction, EActionTrigger.UP, OnTriggerReleased);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void OnTriggerPressed(float value = 0.0, EActionTrigger reason = 0)
+    {
+        OnTriggerInput(true);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void OnTriggerReleased(float value = 0.0, EActionTrigger reason = 0)
+    {
+        OnTriggerInput(false);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void OnTriggerInput(bool held)
+    {
+        if (held == m_bTriggerHeld && m_bTriggerDriven)
+            return;
+        
+        if (m_bAuthority)
+        {
+            SetGunnerTriggerHeld(m_Gunner, held);
+            return;
+        }
+        
+        // Only a press from IDLE is timed, the server takes it without any dead zone in between
+        bool timeRoundTrip = held && GetCurrentState() == AUS_BarrelSpinState.IDLE;
+        
+        SetTriggerHeld(held);
+        
+        // The gunner does not own the weapon, the player controller carries the trigger to the server
+        SCR_PlayerController playerController = SCR_PlayerController.Cast(GetGame().GetPlayerController());
+        if (playerController && m_RplComponent)
+            playerController.AUS_AskSetMinigunTrigger(m_RplComponent.Id(), held);
+        
+        if (!m_bPredicting)
+            return;
+        
+        // A new trigger change is predicted again after a rollback
+        if (m_bRolledBack)
+            SetRolledBack(false);
+        
+        m_bRoundTripPending = timeRoundTrip;
+        if (timeRoundTrip)
+            m_TriggerSentTime = GetServerTime();
+        
+        // Give the server a round trip to confirm before the prediction is checked
+        ScriptCallQueue callQueue = GetGame().GetCallqueue();
+        callQueue.Remove(CheckPrediction);
+        callQueue.CallLater(CheckPrediction, GetPredictionGrace());
+        m_bPredictionCheckPending = true;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Authority: trigger input of a gunner, from the local player or relayed by the gunner's
+    // player controller. Ignored unless the gunner is the one seated on this weapon.
+    void SetGunnerTriggerHeld(IEntity gunner, bool held)
+    {
+        if (!gunner || gunner != m_Gunner)
+            return;
+        
+        m_bGunnerTrigger = held;
+        SetTriggerHeld(held);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Drive firing intent directly, e.g. from scripted gunners. Once used, ammo changes no longer
+    // extend firing until the gunner leaves, so spin-down starts on release.
+    void SetTriggerHeld(bool held)
+    {
+        m_bTriggerHeld = held;
+        
+        if (!m_bTriggerDriven)
+        {
+            m_bTriggerDriven = true;
+            UpdateWeaponFiringControl(GetCurrentState());
+        }
+        
+        if (held)
+            Wake();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool IsTriggerHeld()
+    {
+        return m_bTriggerHeld;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system once per tick. A gunner who dies holding the trigger stays seated without
+    // ever releasing it, so the gunner's trigger is dropped once the gunner is dead or gone.
+    bool PollTriggerHeld()
+    {
+        if (m_bGunnerTrigger && !IsGunnerAlive())
+        {
+            m_bGunnerTrigger = false;
+            SetTriggerHeld(false);
+        }
+        
+        return m_bTriggerHeld;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private bool IsGunnerAlive()
+    {
+        ChimeraCharacter character = ChimeraCharacter.Cast(m_Gunner);
+        if (!character)
+            return m_Gunner != null;
+        
+        CharacterControllerComponent characterController = character.GetCharacterController();
+        return !characterController || !characterController.IsDead();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Resume per-frame updates. Safe to call at any time, does nothing if already awake or on a SIGNALS proxy.
+    void Wake()
+    {
+        if (m_iSlot != -1 || !m_Updater || m_bSignalsProxy)
+            return;
+        
+        m_iSlot = m_Updater.Register(this, IsFollowingServer());
+        
+        if (m_bComponentTicked)
+            SetEventMask(GetOwner(), EntityEvent.FRAME);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system once the outputs have settled in IDLE
+    void Sleep()
+    {
+        if (m_iSlot == -1)
+            return;
+        
+        m_Updater.Unregister(m_iSlot);
+        m_iSlot = -1;
+        
+        if (m_bComponentTicked)
+            ClearEventMask(GetOwner(), EntityEvent.FRAME);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // STATE proxies on the fallback updater tick it as well, SIGNALS proxies while following signals
+    override event protected bool OnTicksOnRemoteProxy()
+    {
+        return m_bComponentTicked || m_bSignalsProxy;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Only set while awake on the fallback updater, or while a SIGNALS proxy follows the signals
+    override event protected void EOnFrame(IEntity owner, float timeSlice)
+    {
+        super.EOnFrame(owner, timeSlice);
+        
+        if (m_bSignalsProxy)
+        {
+            FollowSignals();
+            return;
+        }
+        
+        m_Updater.UpdateFromComponent(owner.GetWorld(), timeSlice);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // A SIGNALS proxy never runs the state machine. While the local player is the gunner, its gate
+    // and reload lock follow the state read back from the replicated signals every frame. Firing
+    // effects follow it too while anyone is seated, an empty turret does not fire.
+    private void UpdateSignalFollowing()
+    {
+        if (!m_bSignalsProxy || !m_SignalsManager)
+            return;
+        
+        bool follow = m_Gunner != null && (m_FiringEffects != null || m_Gunner == SCR_PlayerController.GetLocalControlledEntity());
+        if (follow == m_bFollowingSignals)
+            return;
+        
+        m_bFollowingSignals = follow;
+        
+        if (follow)
+        {
+            if (m_iFiringActiveSignal == -1)
+                InitializeSignals();
+            
+            SetEventMask(GetOwner(), EntityEvent.FRAME);
+            FollowSignals();
+        }
+        else
+        {
+            ClearEventMask(GetOwner(), EntityEvent.FRAME);
+            ApplySignalledState(AUS_BarrelSpinState.IDLE);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void FollowSignals()
+    {
+        ApplySignalledState(GetSignalledState());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void ApplySignalledState(AUS_BarrelSpinState state)
+    {
+        if (m_FiringEffects)
+            m_FiringEffects.Update(state, true);
+        
+        UpdateReloadLock(state);
+        UpdateWeaponFiringControl(state);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // State as streamed by the authority. READY_TO_FIRE sets no flag and is told from IDLE by the
+    // spin signal, which holds the curve start in TRANSITION outputs.
+    private AUS_BarrelSpinState GetSignalledState()
+    {
+        if (m_SignalsManager.GetSignalValue(m_iFiringActiveSignal) > 0.5)
+            return AUS_BarrelSpinState.FIRING;
+        
+        if (m_SignalsManager.GetSignalValue(m_iSpinDownActiveSignal) > 0.5)
+            return AUS_BarrelSpinState.SPIN_DOWN;
+        
+        if (m_SignalsManager.GetSignalValue(m_iSpinUpActiveSignal) > 0.5)
+            return AUS_BarrelSpinState.SPIN_UP;
+        
+        if (m_SignalsManager.GetSignalValue(m_iBarrelSpinSignal) > 0)
+            return AUS_BarrelSpinState.READY_TO_FIRE;
+        
+        return AUS_BarrelSpinState.IDLE;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool IsAwake()
+    {
+        return m_iSlot != -1;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system when slots are compacted
+    void SetSlot(int slot)
+    {
+        m_iSlot = slot;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void InitializeSignals()
+    {
+        if (!m_SignalsManager)
+            return;
+        
+        m_iBarrelSpinSignal = AddSignal("AUS_BarrelSpin", SignalCompressionFunc.Range01);
+        m_iSpinUpActiveSignal = AddSignal("AUS_SpinUpActive", SignalCompressionFunc.Range01);
+        m_iSpinDownActiveSignal = AddSignal("AUS_SpinDownActive", SignalCompressionFunc.Range01);
+        m_iFiringActiveSignal = AddSignal("AUS_FiringActive", SignalCompressionFunc.Range01);
+        
+        if (m_eOutputMode != AUS_BarrelOutputMode.TRANSITION)
+            return;
+        
+        m_iSpinStartSignal = AddSignal("AUS_SpinStart", SignalCompressionFunc.Range01);
+        m_iSpinTargetSignal = AddSignal("AUS_SpinTarget", SignalCompressionFunc.Range01);
+        m_iSpinDurationSignal = AddSignal("AUS_SpinDuration", SignalCompressionFunc.None);
+        m_iSpinCurveSignal = AddSignal("AUS_SpinCurve", SignalCompressionFunc.None);
+        m_iSpinElapsedSignal = AddSignal("AUS_SpinElapsed", SignalCompressionFunc.None);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // In STATE replication every machine computes its own outputs, nothing to stream
+    private int AddSignal(string name, SignalCompressionFunc compression)
+    {
+        if (m_eReplicationMode == AUS_BarrelReplicationMode.STATE)
+            return m_SignalsManager.AddOrFindSignal(name);
+        
+        return m_SignalsManager.AddOrFindMPSignal(name, 0.1, 1.0/30.0, 0, compression);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void InitializeAnimationVariables()
+    {
+        if (!m_AnimationComponent)
+            return;
+            
+        m_iBarrelSpinSpeedVar = m_AnimationComponent.BindVariableFloat("BarrelSpinSpeed");
+        m_iSpinStateVar = m_AnimationComponent.BindVariableInt("SpinState");
+        m_iFiringVar = m_AnimationComponent.BindVariableBool("Firing");
+        m_iVehicleFireReleasedVar = m_AnimationComponent.BindVariableBool("VehicleFireReleased");
+        
+        if (m_eOutputMode != AUS_BarrelOutputMode.TRANSITION)
+            return;
+        
+        array<string> curveNames = {"SpinStart", "SpinTarget", "SpinDuration", "SpinCurve", "SpinElapsed"};
+        m_TransitionVariables = m_AnimationComponent.BindVariableSet(curveNames);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system once per tick. True if a round has been consumed since the last poll.
+    bool PollFiringDetected()
+    {
+        if (m_eFireDetectionMode == AUS_FireDetectionMode.EVENTS)
+        {
+            bool shotDetected = m_bShotPending && !m_bTriggerDriven;
+            m_iLastAmmoDelta = 0;
+            if (m_bShotPending)
+                m_iLastAmmoDelta = -1;
+            
+            m_bShotPending = false;
+            return shotDetected;
+        }
+        
+        int currentAmmoCount = m_Muzzle.GetAmmoCount();
+        int deltaAmmo = currentAmmoCount - m_iPreviousAmmoCount;
+        m_iPreviousAmmoCount = currentAmmoCount;
+        m_iLastAmmoDelta = deltaAmmo;
+        
+        return deltaAmmo < 0 && !m_bTriggerDriven;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Ammo change seen by the last PollFiringDetected. EVENTS detection only knows whether a shot was
+    // pending, so it reports -1 or 0.
+    int GetLastAmmoDelta()
+    {
+        return m_iLastAmmoDelta;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Null unless the prefab enables tracing. Only ticks run on this machine are recorded, not
+    // replicated state.
+    AUS_MinigunTraceRecorder GetTraceRecorder()
+    {
+        return m_TraceRecorder;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Writes the trace buffer to $profile, returns the file path or an empty string
+    string DumpTrace(string reason = "requested")
+    {
+        if (!m_TraceRecorder)
+            return string.Empty;
+        
+        return m_TraceRecorder.Dump(reason);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system whenever the state machine changes state, elapsed is the time (ms)
+    // already spent in the new state
+    void OnStateChanged(AUS_BarrelSpinState state, int elapsed)
+    {
+        if (!m_bAuthority || m_eReplicationMode != AUS_BarrelReplicationMode.STATE)
+            return;
+        
+        m_iRplState = state;
+        m_RplTransitionTime = GetServerTime().PlusMilliseconds(-elapsed);
+        Replication.BumpMe();
+        
+        m_iReplicationUpdates++;
+        m_iReplicatedBytesEstimate += RPL_STATE_BYTES;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Remote proxies rebuild spin speed from the state and the time spent in it
+    private void OnRplBarrelStateChanged()
+    {
+        if (m_bAuthority || m_bSignalsProxy || !m_Updater)
+            return;
+        
+        if (m_bPredicting)
+        {
+            OnPredictedStateReplicated();
+            return;
+        }
+        
+        if (m_bRemoteProxy)
+            ApplyAuthoritativeState();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The server confirms the local trigger once it agrees on whether the gun is engaged. That times
+    // the round trip and, after a rollback, hands the slot back to the prediction.
+    private void OnPredictedStateReplicated()
+    {
+        bool confirmed = IsEngagedState(m_iRplState) == m_bTriggerHeld;
+        if (confirmed && m_bRoundTripPending)
+        {
+            m_bRoundTripPending = false;
+            MeasureRoundTrip(GetServerTime().DiffMilliseconds(m_TriggerSentTime));
+        }
+        
+        if (m_bRolledBack)
+        {
+            ApplyAuthoritativeState();
+            if (confirmed)
+                SetRolledBack(false);
+            
+            return;
+        }
+        
+        if (!m_bPredictionCheckPending)
+            CheckPrediction();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void ApplyAuthoritativeState()
+    {
+        int elapsed = GetServerTime().DiffMilliseconds(m_RplTransitionTime);
+        if (elapsed < 0)
+            elapsed = 0;
+        
+        Wake();
+        m_Updater.SetReplicatedState(m_iSlot, m_iRplState, elapsed);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Server clock, synchronised on clients. Timestamps are 64-bit, so the difference between two
+    // of them stays exact to the millisecond however long the server has been up.
+    private WorldTimestamp GetServerTime()
+    {
+        ChimeraWorld world = ChimeraWorld.CastFrom(GetOwner().GetWorld());
+        return world.GetServerTimestamp();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The local gunner runs the state machine from its own trigger input. Replicated state is
+    // ignored while it is consistent with the prediction.
+    private void SetPredicting(bool predicting)
+    {
+        if (m_bPredicting == predicting)
+            return;
+        
+        m_bPredicting = predicting;
+        m_bRolledBack = false;
+        m_bRoundTripPending = false;
+        
+        if (m_iSlot != -1)
+            m_Updater.SetReplicated(m_iSlot, IsFollowingServer());
+        
+        if (predicting)
+            return;
+        
+        GetGame().GetCallqueue().Remove(CheckPrediction);
+        m_bPredictionCheckPending = false;
+        
+        if (m_bRemoteProxy)
+            ApplyAuthoritativeState();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Timing differences within a phase settle on their own since both sides run the same timers.
+    // Rolls back to the server state only if it disagrees on whether the gun is engaged at all,
+    // e.g. when the server rejected or has not yet acted on the trigger.
+    private void CheckPrediction()
+    {
+        m_bPredictionCheckPending = false;
+        
+        if (!m_bPredicting || m_bRolledBack)
+            return;
+        
+        if (IsEngagedState(GetCurrentState()) == IsEngagedState(m_iRplState))
+            return;
+        
+        SetRolledBack(true);
+        ApplyAuthoritativeState();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // After a rollback the slot follows the server until the next trigger change or until the
+    // server confirms the trigger. Predicting on from the still held trigger would undo it at once.
+    private void SetRolledBack(bool rolledBack)
+    {
+        m_bRolledBack = rolledBack;
+        
+        if (m_iSlot != -1)
+            m_Updater.SetReplicated(m_iSlot, IsFollowingServer());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True if the slot takes its state from replication instead of running its own state machine
+    private bool IsFollowingServer()
+    {
+        return m_bRemoteProxy && (!m_bPredicting || m_bRolledBack);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void MeasureRoundTrip(int roundTrip)
+    {
+        if (m_fRoundTrip < 0)
+            m_fRoundTrip = roundTrip;
+        else
+            m_fRoundTrip += (roundTrip - m_fRoundTrip) * ROUND_TRIP_SMOOTHING;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Time a trigger change is trusted before the server state is checked against it (ms)
+    private int GetPredictionGrace()
+    {
+        if (m_fRoundTrip < 0)
+            return m_iPredictionGrace;
+        
+        return Math.Round(m_fRoundTrip * GRACE_ROUND_TRIPS) + GRACE_MARGIN;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static bool IsEngagedState(AUS_BarrelSpinState state)
+    {
+        return state == AUS_BarrelSpinState.SPIN_UP || state == AUS_BarrelSpinState.READY_TO_FIRE || state == AUS_BarrelSpinState.FIRING;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool IsPredicting()
+    {
+        return m_bPredicting;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system with the freshly computed state. Every tick for PER_FRAME outputs,
+    // only on state changes for TRANSITION outputs.
+    // Animation writes are skipped when animate is false, signal writes when signal is false
+    void ApplyState(AUS_BarrelSpinState state, float spinSpeed, float stateTimer, bool animate = true, bool signal = true)
+    {
+        if (m_eOutputMode == AUS_BarrelOutputMode.TRANSITION)
+            UpdateTransitionOutputs(state, stateTimer, animate, signal);
+        else
+            UpdateOutputs(state, spinSpeed, animate, signal);
+        
+        if (m_FiringEffects)
+            m_FiringEffects.Update(state, animate);
+        
+        // Handle reload and weapon firing control
+        UpdateReloadLock(state);
+        UpdateWeaponFiringControl(state);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void UpdateOutputs(AUS_BarrelSpinState state, float spinSpeed, bool animate, bool signal)
+    {
+        if (!m_SignalsManager)
+            return;
+        
+        if (signal)
+            UpdateSignals(state, spinSpeed);
+        
+        if (animate && m_AnimationComponent && state != AUS_BarrelSpinState.IDLE)
+        {
+            if (IsSpinChanged(spinSpeed, m_fSentSpinVar))
+            {
+                m_AnimationComponent.SetVariableFloat(m_iBarrelSpinSpeedVar, spinSpeed);
+                m_fSentSpinVar = spinSpeed;
+                CountOutputWrite(true, false);
+            }
+            else
+            {
+                CountOutputWrite(false, false);
+            }
+            
+            if (state != m_iSentStateVar)
+            {
+                m_AnimationComponent.SetVariableInt(m_iSpinStateVar, state);
+                m_iSentStateVar = state;
+                CountOutputWrite(true, false);
+            }
+            else
+            {
+                CountOutputWrite(false, false);
+            }
+            
+            WriteVariableBool(m_iFiringVar, state == AUS_BarrelSpinState.FIRING, m_iSentFiringVar);
+            WriteVariableBool(m_iVehicleFireReleasedVar, state == AUS_BarrelSpinState.SPIN_DOWN, m_iSentFireReleasedVar);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Only values that moved are written, so a write after a skipped stretch sends the current state
+    private void UpdateSignals(AUS_BarrelSpinState state, float spinSpeed)
+    {
+        if (IsSpinChanged(spinSpeed, m_fSentSpinSignal))
+        {
+            m_SignalsManager.SetSignalValue(m_iBarrelSpinSignal, spinSpeed);
+            m_fSentSpinSignal = spinSpeed;
+            CountOutputWrite(true, true);
+            CountSignalReplication(1);
+        }
+        else
+        {
+            CountOutputWrite(false, true);
+        }
+        
+        int spinUpActive = 0;
+        int firingActive = 0;
+        int spinDownActive = 0;
+        
+        if (state == AUS_BarrelSpinState.SPIN_UP)
+            spinUpActive = 1;
+        else if (state == AUS_BarrelSpinState.FIRING)
+            firingActive = 1;
+        else if (state == AUS_BarrelSpinState.SPIN_DOWN)
+            spinDownActive = 1;
+        
+        WriteSignal(m_iSpinUpActiveSignal, spinUpActive, m_fSentSpinUpSignal);
+        WriteSignal(m_iFiringActiveSignal, firingActive, m_fSentFiringSignal);
+        WriteSignal(m_iSpinDownActiveSignal, spinDownActive, m_fSentSpinDownSignal);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Sends the curve of the new state once; the animation graph and sound setup evaluate it
+    private void UpdateTransitionOutputs(AUS_BarrelSpinState state, float stateTimer, bool animate, bool signal)
+    {
+        if (!m_SignalsManager)
+            return;
+        
+        float start, target, duration, exponent;
+        m_SpinProfile.GetStateCurve(state, start, target, duration, exponent);
+        
+        if (signal)
+            UpdateTransitionSignals(state, stateTimer, start, target, duration, exponent);
+        
+        if (!animate || !m_AnimationComponent)
+            return;
+        
+        m_TransitionVariables.SetFloat(TRANSITION_VAR_START, start);
+        m_TransitionVariables.SetFloat(TRANSITION_VAR_TARGET, target);
+        m_TransitionVariables.SetFloat(TRANSITION_VAR_DURATION, duration);
+        m_TransitionVariables.SetFloat(TRANSITION_VAR_CURVE, exponent);
+        m_TransitionVariables.SetFloat(TRANSITION_VAR_ELAPSED, stateTimer);
+        
+        int writes = m_AnimationComponent.CommitVariableSet(m_TransitionVariables);
+        CountOutputWrite(true, false, writes);
+        CountOutputWrite(false, false, TRANSITION_VAR_COUNT - writes);
+        
+        m_AnimationComponent.SetVariableInt(m_iSpinStateVar, state);
+        m_iSentStateVar = state;
+        CountOutputWrite(true, false);
+        
+        WriteVariableBool(m_iFiringVar, state == AUS_BarrelSpinState.FIRING, m_iSentFiringVar);
+        WriteVariableBool(m_iVehicleFireReleasedVar, state == AUS_BarrelSpinState.SPIN_DOWN, m_iSentFireReleasedVar);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The curve signals are always sent together, with the time already spent on the curve
+    private void UpdateTransitionSignals(AUS_BarrelSpinState state, float stateTimer, float start, float target, float duration, float exponent)
+    {
+        m_SignalsManager.SetSignalValue(m_iBarrelSpinSignal, start);
+        m_SignalsManager.SetSignalValue(m_iSpinStartSignal, start);
+        m_SignalsManager.SetSignalValue(m_iSpinTargetSignal, target);
+        m_SignalsManager.SetSignalValue(m_iSpinDurationSignal, duration);
+        m_SignalsManager.SetSignalValue(m_iSpinCurveSignal, exponent);
+        m_SignalsManager.SetSignalValue(m_iSpinElapsedSignal, stateTimer);
+        m_fSentSpinSignal = start;
+        CountOutputWrite(true, true, 6);
+        CountSignalReplication(15);
+        
+        int spinUpActive = 0;
+        int firingActive = 0;
+        int spinDownActive = 0;
+        
+        if (state == AUS_BarrelSpinState.SPIN_UP)
+            spinUpActive = 1;
+        else if (state == AUS_BarrelSpinState.FIRING)
+            firingActive = 1;
+        else if (state == AUS_BarrelSpinState.SPIN_DOWN)
+            spinDownActive = 1;
+        
+        WriteSignal(m_iSpinUpActiveSignal, spinUpActive, m_fSentSpinUpSignal);
+        WriteSignal(m_iFiringActiveSignal, firingActive, m_fSentFiringSignal);
+        WriteSignal(m_iSpinDownActiveSignal, spinDownActive, m_fSentSpinDownSignal);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Spin changes below the epsilon are dropped, except when landing on 0 or 1
+    private bool IsSpinChanged(float spinSpeed, float sentSpinSpeed)
+    {
+        if (spinSpeed == sentSpinSpeed)
+            return false;
+        
+        if (spinSpeed <= 0.0 || spinSpeed >= 1.0)
+            return true;
+        
+        return Math.AbsFloat(spinSpeed - sentSpinSpeed) >= m_fSpinOutputEpsilon;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void WriteSignal(int signalId, float value, inout float sentValue)
     {
-        if (m_eCurrentState == AUS_BarrelSpinState.SPIN_UP)
+        if (value == sentValue)
         {
-            return Math.Clamp(m_fStateTimer / m_fSpinUpTime, 0.0, 1.0);
+            CountOutputWrite(false, true);
+            return;
         }
-        else if (m_eCurrentState == AUS_BarrelSpinState.READY_TO_FIRE)
+        
+        m_SignalsManager.SetSignalValue(signalId, value);
+        sentValue = value;
+        CountOutputWrite(true, true);
+        CountSignalReplication(1);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // sentValue is -1 until the first write, then 0 or 1
+    private void WriteVariableBool(int variableId, bool value, inout int sentValue)
+    {
+        int intValue = 0;
+        if (value)
+            intValue = 1;
+        
+        if (intValue == sentValue)
         {
-            return Math.Clamp(m_fStateTimer / m_fFiringDelay, 0.0, 1.0);
+            CountOutputWrite(false, false);
+            return;
         }
-        else if (m_eCurrentState == AUS_BarrelSpinState.SPIN_DOWN)
+        
+        m_AnimationComponent.SetVariableBool(variableId, value);
+        sentValue = intValue;
+        CountOutputWrite(true, false);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void CountOutputWrite(bool issued, bool signal, int count = 1)
+    {
+        if (issued)
         {
-            return Math.Clamp(m_fStateTimer / m_fSpinDownTime, 0.0, 1.0);
+            m_iOutputWritesIssued += count;
+            s_iOutputWritesIssued += count;
+            
+            if (AUS_MinigunProfiler.s_bEnabled)
+            {
+                if (signal)
+                    GetProfilerStats().m_iSignalWrites += count;
+                else
+                    GetProfilerStats().m_iAnimationWrites += count;
+            }
         }
         else
         {
-            return 0.0;
+            m_iOutputWritesSkipped += count;
+            s_iOutputWritesSkipped += count;
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Upper bound for SIGNALS replication: every issued MP signal write is counted as sent, with
+    // Range01 signals as one byte and uncompressed ones as four
+    private void CountSignalReplication(int bytes)
+    {
+        if (!m_bAuthority || m_eReplicationMode != AUS_BarrelReplicationMode.SIGNALS)
+            return;
+        
+        m_iReplicationUpdates++;
+        m_iReplicatedBytesEstimate += bytes;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Only call while AUS_MinigunProfiler.s_bEnabled. The profiler owns the stats; after a reset
+    // the weak reference is gone and fresh stats are created.
+    AUS_MinigunControllerStats GetProfilerStats()
+    {
+        if (!m_ProfilerStats)
+            m_ProfilerStats = AUS_MinigunProfiler.CreateStats(string.Format("%1 %2", GetOwner().GetID(), GetOwner().GetRootParent().GetName()));
+        
+        return m_ProfilerStats;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Replicated updates sent by this controller and an estimate of their payload size
+    void GetReplicationEstimate(out int updates, out int bytes)
+    {
+        updates = m_iReplicationUpdates;
+        bytes = m_iReplicatedBytesEstimate;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Signal and animation writes issued and skipped by this controller
+    void GetOutputWriteCounts(out int issued, out int skipped)
+    {
+        issued = m_iOutputWritesIssued;
+        skipped = m_iOutputWritesSkipped;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Signal and animation writes issued and skipped by all controllers
+    static void GetTotalOutputWriteCounts(out int issued, out int skipped)
+    {
+        issued = s_iOutputWritesIssued;
+        skipped = s_iOutputWritesSkipped;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void UpdateReloadLock(AUS_BarrelSpinState state)
+    {
+        bool shouldLockReload = (state != AUS_BarrelSpinState.IDLE);
+        
+        if (shouldLockReload != m_bReloadLocked)
+        {
+            m_bReloadLocked = shouldLockReload;
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The muzzle is only held back while a trigger drives the gun. Gunners without trigger input
+    // are detected by their shots, so blocking them would keep the barrel from ever spinning up.
+    private void UpdateWeaponFiringControl(AUS_BarrelSpinState state)
+    {
+        bool shouldAllowFiring = (state == AUS_BarrelSpinState.FIRING);
+        
+        if (shouldAllowFiring != !m_bWeaponFiringBlocked)
+        {
+            if (shouldAllowFiring)
+            {
+                m_bWeaponFiringBlocked = false;
+            }
+            else
+            {
+                m_bWeaponFiringBlocked = true;
+            }
         }
+        
+        if (m_WeaponGate)
+            m_WeaponGate.SetBlocked(m_bWeaponFiringBlocked && m_bTriggerDriven);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_BarrelSpinState GetCurrentState()
+    {
+        if (m_iSlot == -1)
+            return AUS_BarrelSpinState.IDLE;
+        
+        return m_Updater.GetState(m_iSlot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetCurrentSpinSpeed()
+    {
+        if (m_iSlot == -1)
+            return 0.0;
+        
+        return m_Updater.GetSpinSpeed(m_iSlot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True while the barrels are not IDLE, checked by the turret reload action
+    bool IsReloadLocked()
+    {
+        return m_bReloadLocked;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True while the gate holds the muzzle for a trigger-driven gunner outside FIRING
+    bool IsMuzzleGated()
+    {
+        return m_WeaponGate != null && m_bTriggerDriven;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool CanWeaponFire()
+    {
+        return !m_bWeaponFiringBlocked && (GetCurrentState() == AUS_BarrelSpinState.FIRING);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetStateProgress()
+    {
+        if (m_iSlot == -1)
+            return 0.0;
+        
+        return m_Updater.GetStateProgress(m_iSlot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // False if spin speed is only needed on demand, outputs are then written on transitions only
+    bool HasPerFrameOutputs()
+    {
+        return m_eOutputMode != AUS_BarrelOutputMode.TRANSITION;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // False while other machines depend on this instance's signal stream, i.e. the authority of a
+    // multiplayer session in SIGNALS replication
+    bool AllowsLod()
+    {
+        return !m_bAuthority || m_eReplicationMode != AUS_BarrelReplicationMode.SIGNALS || RplSession.Mode() == RplMode.None;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True if this instance decides the gun's state, which the muzzle gate and replication follow
+    bool IsAuthoritative()
+    {
+        return m_bAuthority;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True where signal writes only feed replication, i.e. the authority of a multiplayer session
+    // in SIGNALS replication. STATE replication only sends on state changes and needs no culling.
+    bool UsesRelevance()
+    {
+        return !AllowsLod();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_MinigunAirframeGroup GetAirframeGroup()
+    {
+        return m_AirframeGroup;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_MinigunSpinProfile GetSpinProfile()
+    {
+        return m_SpinProfile;
     }
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+// Minigun controllers mounted on one vehicle, e.g. the two door guns of a helicopter.
+// The group subscribes to the vehicle's compartment events once and fans them out to its members,
+// and measures the vehicle against the camera and the players once per frame for all of them, so
+// the per-vehicle cost stays flat as weapon stations are added. Each gun keeps its own state machine
+// slot and outputs. Groups are owned by AUS_MinigunBarrelUpdater.
+class AUS_MinigunAirframeGroup
+{
+    private IEntity m_Vehicle;
+    private EventHandlerManagerComponent m_EventHandler;
+    private ref array<AUS_MinigunBarrelController> m_aMembers = {};
+    
+    // Measurements, valid for the frame they were taken in
+    private int m_iCameraFrame = -1;
+    private float m_fCameraDistanceSq;
+    private float m_fCameraDot;
+    private int m_iPlayerFrame = -1;
+    private float m_fNearestPlayerSq;
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_MinigunAirframeGroup(notnull IEntity vehicle)
+    {
+        m_Vehicle = vehicle;
+        m_EventHandler = EventHandlerManagerComponent.Cast(vehicle.FindComponent(EventHandlerManagerComponent));
+        if (!m_EventHandler)
+            return;
+        
+        m_EventHandler.RegisterScriptHandler("OnCompartmentEntered", this, OnCompartmentEntered);
+        m_EventHandler.RegisterScriptHandler("OnCompartmentLeft", this, OnCompartmentLeft);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void ~AUS_MinigunAirframeGroup()
+    {
+        if (!m_EventHandler)
+            return;
+        
+        m_EventHandler.RemoveScriptHandler("OnCompartmentEntered", this, OnCompartmentEntered);
+        m_EventHandler.RemoveScriptHandler("OnCompartmentLeft", this, OnCompartmentLeft);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void Add(notnull AUS_MinigunBarrelController controller)
+    {
+        if (!m_aMembers.Contains(controller))
+            m_aMembers.Insert(controller);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Returns true once the group is empty
+    bool Remove(AUS_MinigunBarrelController controller)
+    {
+        m_aMembers.RemoveItem(controller);
+        return m_aMembers.IsEmpty();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    IEntity GetVehicle()
+    {
+        return m_Vehicle;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetMemberCount()
+    {
+        return m_aMembers.Count();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void OnCompartmentEntered(IEntity vehicle, BaseCompartmentManagerComponent manager, IEntity occupant, int managerId, int slotId)
+    {
+        foreach (AUS_MinigunBarrelController member : m_aMembers)
+        {
+            member.OnCompartmentEntered(vehicle, manager, occupant, managerId, slotId);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void OnCompartmentLeft(IEntity vehicle, BaseCompartmentManagerComponent manager, IEntity occupant, int managerId, int slotId)
+    {
+        foreach (AUS_MinigunBarrelController member : m_aMembers)
+        {
+            member.OnCompartmentLeft(vehicle, manager, occupant, managerId, slotId);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Squared distance from the camera and dot(toTarget, camera forward), not normalised
+    static void MeasureCamera(vector origin, vector camera[4], out float distanceSq, out float viewDot)
+    {
+        vector toTarget = origin - camera[3];
+        distanceSq = toTarget.LengthSq();
+        viewDot = vector.Dot(toTarget, camera[2]);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // float.MAX without players
+    static float MeasureNearestPlayer(vector origin, notnull array<vector> playerPositions)
+    {
+        float nearestSq = float.MAX;
+        foreach (vector position : playerPositions)
+        {
+            float distanceSq = vector.DistanceSq(origin, position);
+            if (distanceSq < nearestSq)
+                nearestSq = distanceSq;
+        }
+        
+        return nearestSq;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Vehicle measurement, taken by the first member that asks in a frame
+    void GetCameraMeasurement(int frame, vector camera[4], out float distanceSq, out float viewDot)
+    {
+        if (m_iCameraFrame != frame)
+        {
+            m_iCameraFrame = frame;
+            MeasureCamera(m_Vehicle.GetOrigin(), camera, m_fCameraDistanceSq, m_fCameraDot);
+        }
+        
+        distanceSq = m_fCameraDistanceSq;
+        viewDot = m_fCameraDot;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetNearestPlayerMeasurement(int frame, notnull array<vector> playerPositions)
+    {
+        if (m_iPlayerFrame != frame)
+        {
+            m_iPlayerFrame = frame;
+            m_fNearestPlayerSq = MeasureNearestPlayer(m_Vehicle.GetOrigin(), playerPositions);
+        }
+        
+        return m_fNearestPlayerSq;
+    }
+}
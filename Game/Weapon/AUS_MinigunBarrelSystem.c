@@ -0,0 +1,547 @@
+// Ticks every awake AUS_MinigunBarrelController in one pass.
+// Hot state lives in an AUS_MinigunStateMachine indexed by slot; the components are thin handles
+// that only gather inputs and write outputs. Sleeping controllers hold no slot.
+// Normally owned and ticked by AUS_MinigunBarrelSystem. Worlds whose systems config does not list
+// the system share a fallback instance, ticked by the frame events of its awake controllers.
+class AUS_MinigunBarrelUpdater
+{
+    private static ref AUS_MinigunBarrelUpdater s_Fallback;
+    private static BaseWorld s_FallbackWorld;
+    
+    // World time of the last update driven by a controller, so it runs once per frame
+    private float m_fComponentUpdateTime = -1;
+    
+    // Handles
+    private ref array<AUS_MinigunBarrelController> m_aControllers = {};
+    
+    // Hot state, same indices as m_aControllers
+    private ref AUS_MinigunStateMachine m_StateMachine = new AUS_MinigunStateMachine();
+    
+    // Slots whose state is set by replication rather than by their own state machine
+    private ref array<bool> m_aReplicated = {};
+    
+    // Slots that need spin speed and outputs every tick, others only on state changes
+    private ref array<bool> m_aPerFrameOutput = {};
+    private ref array<bool> m_aStateChanged = {};
+    
+    // Update rate LOD. Slots skipped by their tier collect the time they missed in m_aLodPending and
+    // catch up on their next update; timed transitions carry the overshoot, so they still land on time.
+    private static const float LOD_VIEW_COS = 0.5;
+    private ref array<int> m_aLodTier = {};
+    private ref array<float> m_aLodPending = {};
+    private ref array<bool> m_aLodAllowed = {};
+    private int m_iFrame = 0;
+    
+    // Slots whose state machine is authoritative. The muzzle gate and replication follow it, so it
+    // runs every frame and the LOD tier only thins its output writes.
+    private ref array<bool> m_aAuthoritative = {};
+    
+    // Network relevance on the authority. Positions of player controlled entities are gathered once
+    // per frame, and only when a slot needs them.
+    private ref array<int> m_aRelevanceTier = {};
+    private ref array<bool> m_aRelevanceAllowed = {};
+    private ref array<int> m_aPlayerIds = {};
+    private ref array<vector> m_aPlayerPositions = {};
+    
+    // Controllers sharing a vehicle, keyed by the vehicle. Slots of grouped controllers take their
+    // distance checks from the group, which measures once per frame.
+    private ref map<IEntity, ref AUS_MinigunAirframeGroup> m_mAirframeGroups = new map<IEntity, ref AUS_MinigunAirframeGroup>();
+    private ref array<AUS_MinigunAirframeGroup> m_aAirframeGroup = {};
+    
+    // Update timing (ms), since the last ResetUpdateStats
+    private int m_iUpdateFrames = 0;
+    private int m_iUpdateTime = 0;
+    private int m_iPeakUpdateTime = 0;
+    
+    //------------------------------------------------------------------------------------------------
+    // Shared by every controller of the world, replaced when the world changes
+    static AUS_MinigunBarrelUpdater GetFallback(BaseWorld world)
+    {
+        if (!s_Fallback || s_FallbackWorld != world)
+        {
+            Print("[AUS_MinigunBarrelUpdater] AUS_MinigunBarrelSystem is not in the world's systems config, controllers tick themselves", LogLevel.WARNING);
+            AUS_MinigunProfiler.Init();
+            s_Fallback = new AUS_MinigunBarrelUpdater();
+            s_FallbackWorld = world;
+        }
+        
+        return s_Fallback;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True for the fallback, whose controllers drive updates from their own frame event
+    bool IsComponentTicked()
+    {
+        return this == s_Fallback;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called from the frame event of every awake controller of the fallback, only the first call
+    // of a frame updates
+    void UpdateFromComponent(notnull BaseWorld world, float frameSlice)
+    {
+        float worldTime = world.GetWorldTime();
+        if (worldTime == m_fComponentUpdateTime)
+            return;
+        
+        m_fComponentUpdateTime = worldTime;
+        Update(world, frameSlice);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Returns the slot assigned to the controller.
+    // Replicated slots only advance their timer and spin; transitions come from SetReplicatedState.
+    int Register(notnull AUS_MinigunBarrelController controller, bool replicated = false)
+    {
+        int slot = m_aControllers.Insert(controller);
+        
+        m_StateMachine.Add(controller.GetSpinProfile(), System.GetTickCount());
+        m_aReplicated.Insert(replicated);
+        m_aPerFrameOutput.Insert(controller.HasPerFrameOutputs());
+        m_aStateChanged.Insert(true);
+        m_aLodTier.Insert(AUS_BarrelLodTier.FULL);
+        m_aLodPending.Insert(0.0);
+        m_aLodAllowed.Insert(controller.AllowsLod());
+        m_aAuthoritative.Insert(controller.IsAuthoritative());
+        m_aRelevanceTier.Insert(AUS_BarrelRelevanceTier.FULL);
+        m_aRelevanceAllowed.Insert(controller.UsesRelevance());
+        m_aAirframeGroup.Insert(controller.GetAirframeGroup());
+        
+        return slot;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Frees the slot by moving the last slot into it
+    void Unregister(int slot)
+    {
+        int last = m_aControllers.Count() - 1;
+        if (slot < 0 || slot > last)
+            return;
+        
+        m_aControllers.Remove(slot);
+        m_StateMachine.Remove(slot);
+        m_aReplicated.Remove(slot);
+        m_aPerFrameOutput.Remove(slot);
+        m_aStateChanged.Remove(slot);
+        m_aLodTier.Remove(slot);
+        m_aLodPending.Remove(slot);
+        m_aLodAllowed.Remove(slot);
+        m_aAuthoritative.Remove(slot);
+        m_aRelevanceTier.Remove(slot);
+        m_aRelevanceAllowed.Remove(slot);
+        m_aAirframeGroup.Remove(slot);
+        
+        if (slot != last)
+            m_aControllers[slot].SetSlot(slot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void Update(notnull BaseWorld world, float frameSlice)
+    {
+        AUS_MinigunProfiler.OnFrame(frameSlice);
+        bool profiling = AUS_MinigunProfiler.s_bEnabled;
+        
+        int count = m_aControllers.Count();
+        if (count == 0)
+            return;
+        
+        int updateStart = System.GetTickCount();
+        int currentTime = updateStart;
+        m_iFrame++;
+        
+        // A dedicated server has no camera, everything runs at full rate there
+        vector camera[4];
+        bool hasCamera = RplSession.Mode() != RplMode.Dedicated;
+        if (hasCamera)
+            world.GetCurrentCamera(camera);
+        
+        bool hasPlayerPositions = false;
+        
+        // Inputs and state machine
+        for (int i = 0; i < count; i++)
+        {
+            m_aLodPending[i] = m_aLodPending[i] + frameSlice;
+            
+            AUS_BarrelLodTier tier = AUS_BarrelLodTier.FULL;
+            if (hasCamera && m_aLodAllowed[i])
+                tier = EvaluateLodTier(i, camera);
+            
+            // Coming closer or into view writes outputs straight away
+            if (tier != m_aLodTier[i])
+            {
+                if (tier < m_aLodTier[i])
+                    m_aStateChanged[i] = true;
+                
+                m_aLodTier[i] = tier;
+            }
+            
+            if (m_aRelevanceAllowed[i])
+            {
+                if (!hasPlayerPositions)
+                {
+                    GatherPlayerPositions();
+                    hasPlayerPositions = true;
+                }
+                
+                // A player coming into range gets the current state straight away
+                AUS_BarrelRelevanceTier relevance = EvaluateRelevanceTier(i);
+                if (relevance < m_aRelevanceTier[i])
+                    m_aStateChanged[i] = true;
+                
+                m_aRelevanceTier[i] = relevance;
+            }
+            
+            if (!m_aAuthoritative[i] && !IsLodDue(i))
+                continue;
+            
+            float timeSlice = m_aLodPending[i];
+            m_aLodPending[i] = 0.0;
+            
+            if (m_aReplicated[i])
+            {
+                m_StateMachine.AdvanceTimer(i, timeSlice);
+            }
+            else
+            {
+                AUS_MinigunBarrelController controller = m_aControllers[i];
+                bool shotDetected = controller.PollFiringDetected();
+                bool triggerHeld = controller.PollTriggerHeld();
+                bool isFiring = m_StateMachine.ResolveFiring(i, shotDetected, triggerHeld, currentTime);
+                AUS_BarrelSpinState previousState = m_StateMachine.GetState(i);
+                float previousTimer = m_StateMachine.GetStateTimer(i);
+                float previousAccumulator = m_StateMachine.GetStepAccumulator(i);
+                
+                if (m_StateMachine.Step(i, isFiring, currentTime, timeSlice))
+                {
+                    m_aStateChanged[i] = true;
+                    controller.OnStateChanged(m_StateMachine.GetState(i), m_StateMachine.GetStateElapsed(i, currentTime));
+                    
+                    if (profiling)
+                        controller.GetProfilerStats().CountTransition(previousState, m_StateMachine.GetState(i));
+                }
+                
+                AUS_MinigunTraceRecorder traceRecorder = controller.GetTraceRecorder();
+                if (traceRecorder)
+                {
+                    traceRecorder.Record(currentTime, timeSlice, controller.GetLastAmmoDelta(), shotDetected, triggerHeld, isFiring,
+                        previousState, previousTimer, previousAccumulator, m_StateMachine.GetState(i), controller.IsMuzzleGated(), m_StateMachine.IsSuppressing(i));
+                }
+                
+                if (profiling)
+                    controller.GetProfilerStats().m_iDeadZoneSuppressions += m_StateMachine.ConsumeDeadZoneSuppressions(i);
+            }
+            
+            if (profiling)
+                m_aControllers[i].GetProfilerStats().m_iTicks++;
+            
+            if (m_aPerFrameOutput[i])
+                m_StateMachine.CalculateSpinSpeed(i);
+        }
+        
+        // Outputs. Walk backwards so that putting a controller to sleep only moves already visited slots.
+        for (int i = count - 1; i >= 0; i--)
+        {
+            // Skipped by its LOD tier this frame
+            if (m_aLodPending[i] > 0)
+                continue;
+            
+            AUS_MinigunBarrelController controller = m_aControllers[i];
+            bool sleeping = m_StateMachine.GetState(i) == AUS_BarrelSpinState.IDLE && !m_StateMachine.IsFiring(i);
+            
+            // Authoritative slots tick every frame but only write outputs when their tier is due
+            if ((m_aPerFrameOutput[i] || m_aStateChanged[i]) && (sleeping || IsLodDue(i)))
+            {
+                if (!m_aPerFrameOutput[i])
+                    m_StateMachine.CalculateSpinSpeed(i);
+                
+                // The IDLE write before sleeping always goes out, nothing else would correct the signals later
+                bool signal = true;
+                AUS_BarrelRelevanceTier relevance = m_aRelevanceTier[i];
+                if (relevance == AUS_BarrelRelevanceTier.CULLED && !sleeping)
+                    signal = false;
+                else if (relevance == AUS_BarrelRelevanceTier.REDUCED && !m_aStateChanged[i] && (m_iFrame + i) % m_StateMachine.GetProfile(i).GetRelevanceInterval() != 0)
+                    signal = false;
+                
+                m_aStateChanged[i] = false;
+                controller.ApplyState(m_StateMachine.GetState(i), m_StateMachine.GetSpinSpeed(i), m_StateMachine.GetStateTimer(i), m_aLodTier[i] != AUS_BarrelLodTier.CULLED, signal);
+            }
+            
+            // Outputs have been written for IDLE, nothing left to do until the next wake event
+            if (sleeping)
+                controller.Sleep();
+        }
+        
+        int updateTime = System.GetTickCount(updateStart);
+        m_iUpdateFrames++;
+        m_iUpdateTime += updateTime;
+        if (updateTime > m_iPeakUpdateTime)
+            m_iPeakUpdateTime = updateTime;
+        
+        if (profiling)
+            AUS_MinigunProfiler.RecordUpdate(updateTime);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True on the frames a slot's LOD tier updates it: every frame while FULL or after a state
+    // change, every LOD interval otherwise
+    private bool IsLodDue(int i)
+    {
+        return m_aLodTier[i] == AUS_BarrelLodTier.FULL || m_aStateChanged[i] || (m_iFrame + i) % m_StateMachine.GetProfile(i).GetLodInterval() == 0;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Near guns are FULL. Beyond that, guns past the far distance or outside the view cone are CULLED
+    // and the rest are REDUCED.
+    private AUS_BarrelLodTier EvaluateLodTier(int i, vector camera[4])
+    {
+        AUS_MinigunSpinProfile profile = m_StateMachine.GetProfile(i);
+        float distanceSq, viewDot;
+        AUS_MinigunAirframeGroup group = m_aAirframeGroup[i];
+        if (group)
+            group.GetCameraMeasurement(m_iFrame, camera, distanceSq, viewDot);
+        else
+            AUS_MinigunAirframeGroup.MeasureCamera(m_aControllers[i].GetOwner().GetOrigin(), camera, distanceSq, viewDot);
+        
+        if (distanceSq <= profile.GetLodNearDistanceSq())
+            return AUS_BarrelLodTier.FULL;
+        
+        if (distanceSq >= profile.GetLodFarDistanceSq())
+            return AUS_BarrelLodTier.CULLED;
+        
+        // Compare against the cone without normalising: dot(toGun, forward) < cos * |toGun|
+        if (profile.IsLodCullingOffscreen() && viewDot < LOD_VIEW_COS * Math.Sqrt(distanceSq))
+            return AUS_BarrelLodTier.CULLED;
+        
+        return AUS_BarrelLodTier.REDUCED;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void GatherPlayerPositions()
+    {
+        m_aPlayerPositions.Clear();
+        
+        PlayerManager playerManager = GetGame().GetPlayerManager();
+        playerManager.GetPlayers(m_aPlayerIds);
+        foreach (int playerId : m_aPlayerIds)
+        {
+            IEntity controlled = playerManager.GetPlayerControlledEntity(playerId);
+            if (controlled)
+                m_aPlayerPositions.Insert(controlled.GetOrigin());
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // FULL while any player is within the near distance, CULLED while all are beyond the far
+    // distance, REDUCED in between. Players without a controlled entity count as out of range.
+    private AUS_BarrelRelevanceTier EvaluateRelevanceTier(int i)
+    {
+        AUS_MinigunSpinProfile profile = m_StateMachine.GetProfile(i);
+        float nearestSq;
+        AUS_MinigunAirframeGroup group = m_aAirframeGroup[i];
+        if (group)
+            nearestSq = group.GetNearestPlayerMeasurement(m_iFrame, m_aPlayerPositions);
+        else
+            nearestSq = AUS_MinigunAirframeGroup.MeasureNearestPlayer(m_aControllers[i].GetOwner().GetOrigin(), m_aPlayerPositions);
+        
+        if (nearestSq <= profile.GetRelevanceNearDistanceSq())
+            return AUS_BarrelRelevanceTier.FULL;
+        
+        if (nearestSq >= profile.GetRelevanceFarDistanceSq())
+            return AUS_BarrelRelevanceTier.CULLED;
+        
+        return AUS_BarrelRelevanceTier.REDUCED;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Adds the controller to the group of the vehicle, creating the group on first use
+    AUS_MinigunAirframeGroup JoinAirframeGroup(notnull AUS_MinigunBarrelController controller, notnull IEntity vehicle)
+    {
+        AUS_MinigunAirframeGroup group = m_mAirframeGroups.Get(vehicle);
+        if (!group)
+        {
+            group = new AUS_MinigunAirframeGroup(vehicle);
+            m_mAirframeGroups.Insert(vehicle, group);
+        }
+        
+        group.Add(controller);
+        return group;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void LeaveAirframeGroup(notnull AUS_MinigunBarrelController controller, notnull AUS_MinigunAirframeGroup group)
+    {
+        if (group.Remove(controller))
+            m_mAirframeGroups.Remove(group.GetVehicle());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // For controllers that join or leave a group while awake
+    void SetAirframeGroup(int slot, AUS_MinigunAirframeGroup group)
+    {
+        if (slot < 0 || slot >= m_aControllers.Count())
+            return;
+        
+        m_aAirframeGroup[slot] = group;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetAirframeGroupCount()
+    {
+        return m_mAirframeGroups.Count();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_BarrelLodTier GetLodTier(int slot)
+    {
+        return m_aLodTier[slot];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_BarrelRelevanceTier GetRelevanceTier(int slot)
+    {
+        return m_aRelevanceTier[slot];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void SetReplicated(int slot, bool replicated)
+    {
+        if (slot < 0 || slot >= m_aControllers.Count())
+            return;
+        
+        m_aReplicated[slot] = replicated;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Applies a state received from the authority, elapsed is the time already spent in it (ms)
+    void SetReplicatedState(int slot, AUS_BarrelSpinState state, float elapsed)
+    {
+        if (slot < 0 || slot >= m_aControllers.Count())
+            return;
+        
+        if (AUS_MinigunProfiler.s_bEnabled && state != m_StateMachine.GetState(slot))
+            m_aControllers[slot].GetProfilerStats().CountTransition(m_StateMachine.GetState(slot), state);
+        
+        m_StateMachine.SetState(slot, state, elapsed, System.GetTickCount());
+        m_StateMachine.CalculateSpinSpeed(slot);
+        m_aStateChanged[slot] = true;
+        
+        // Elapsed already covers the time the LOD tier skipped
+        m_aLodPending[slot] = 0.0;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_BarrelSpinState GetState(int slot)
+    {
+        return m_StateMachine.GetState(slot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetSpinSpeed(int slot)
+    {
+        if (!m_aPerFrameOutput[slot])
+            m_StateMachine.CalculateSpinSpeed(slot);
+        
+        return m_StateMachine.GetSpinSpeed(slot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetStateProgress(int slot)
+    {
+        return m_StateMachine.GetStateProgress(slot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetStateTimer(int slot)
+    {
+        return m_StateMachine.GetStateTimer(slot);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetTimeSinceFire(int slot)
+    {
+        return m_StateMachine.GetTimeSinceFire(slot, System.GetTickCount());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void SetTimeSinceFire(int slot, int timeSinceFire)
+    {
+        if (slot < 0 || slot >= m_aControllers.Count())
+            return;
+        
+        m_StateMachine.SetTimeSinceFire(slot, timeSinceFire, System.GetTickCount());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Frames with at least one awake controller and the time spent updating them. Millisecond
+    // resolution, so only totals over many frames are meaningful.
+    void GetUpdateStats(out int frames, out int totalTime, out int peakTime)
+    {
+        frames = m_iUpdateFrames;
+        totalTime = m_iUpdateTime;
+        peakTime = m_iPeakUpdateTime;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void ResetUpdateStats()
+    {
+        m_iUpdateFrames = 0;
+        m_iUpdateTime = 0;
+        m_iPeakUpdateTime = 0;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetRegisteredCount()
+    {
+        return m_aControllers.Count();
+    }
+}
+
+// Ticks the world's AUS_MinigunBarrelUpdater once per frame. Needs an entry in the world's systems
+// config; without one controllers fall back to ticking themselves, see GetUpdater.
+class AUS_MinigunBarrelSystem : GameSystem
+{
+    private ref AUS_MinigunBarrelUpdater m_Updater = new AUS_MinigunBarrelUpdater();
+    
+    //------------------------------------------------------------------------------------------------
+    override static void InitInfo(WorldSystemInfo outInfo)
+    {
+        outInfo
+            .SetAbstract(false)
+            .SetLocation(ESystemLocation.Both)
+            .AddPoint(ESystemPoint.Frame);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    override protected void OnInit()
+    {
+        AUS_MinigunProfiler.Init();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    override protected void OnUpdate(ESystemPoint point)
+    {
+        BaseWorld world = GetWorld();
+        m_Updater.Update(world, world.GetTimeSlice());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    static AUS_MinigunBarrelSystem GetInstance(BaseWorld world)
+    {
+        ChimeraWorld chimeraWorld = ChimeraWorld.CastFrom(world);
+        if (!chimeraWorld)
+            return null;
+        
+        return AUS_MinigunBarrelSystem.Cast(chimeraWorld.FindSystem(AUS_MinigunBarrelSystem));
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The system's updater, or the fallback when the system is not running in this world
+    static AUS_MinigunBarrelUpdater GetUpdater(BaseWorld world)
+    {
+        AUS_MinigunBarrelSystem system = GetInstance(world);
+        if (system)
+            return system.m_Updater;
+        
+        return AUS_MinigunBarrelUpdater.GetFallback(world);
+    }
+}
@@ -0,0 +1,338 @@
+class AUS_MinigunBenchmarkEntityClass : GenericEntityClass
+{
+}
+
+// Stress benchmark for mass M134 engagements. Place one in an otherwise empty world and start it as
+// a dedicated server. The authority spawns a grid of armed helicopters, seats a gunner in every
+// turret and has each gunner fire real bursts through the weapon on a fixed staggered schedule, so
+// the figures cover rounds, ammo detection and signal traffic. After the measuring window it writes
+// a summary file. Replicated bytes are the controllers' own estimate rather than measured traffic.
+// Belts are not reloaded during the run, so they should hold enough rounds for the window.
+// Started with -scrDefine AUS_MINIGUN_BENCHMARK_BASELINE the benchmark uses no controller API, so
+// the same file measures the baseline controller; the summary then leaves out controller figures.
+class AUS_MinigunBenchmarkEntity : GenericEntity
+{
+    [Attribute("", UIWidgets.ResourcePickerThumbnail, "Helicopter prefab carrying AUS M134 door guns", "et")]
+    protected ResourceName m_sVehiclePrefab;
+    
+    [Attribute("", UIWidgets.ResourcePickerThumbnail, "Character seated in every turret as gunner. Its AI must stay inactive, it only fires on the schedule.", "et")]
+    protected ResourceName m_sGunnerPrefab;
+    
+    [Attribute("40", UIWidgets.EditBox, "Number of helicopters to spawn")]
+    protected int m_iVehicleCount;
+    
+    [Attribute("30", UIWidgets.EditBox, "Grid spacing between helicopters (m)")]
+    protected float m_fSpacing;
+    
+    [Attribute("2000", UIWidgets.EditBox, "Trigger held per burst (ms)")]
+    protected int m_iBurstTime;
+    
+    [Attribute("3000", UIWidgets.EditBox, "Pause between bursts (ms)")]
+    protected int m_iPauseTime;
+    
+    [Attribute("137", UIWidgets.EditBox, "Schedule offset between consecutive guns (ms)")]
+    protected int m_iStagger;
+    
+    [Attribute("10", UIWidgets.EditBox, "Time after spawning before measuring starts (s)")]
+    protected float m_fWarmupTime;
+    
+    [Attribute("60", UIWidgets.EditBox, "Measuring window (s)")]
+    protected float m_fMeasureTime;
+    
+    [Attribute("$profile:AUS_MinigunBenchmark.txt", UIWidgets.EditBox, "Summary file")]
+    protected string m_sSummaryPath;
+    
+    [Attribute("1", UIWidgets.CheckBox, "Close the game once the summary is written")]
+    protected bool m_bQuitWhenDone;
+    
+    private ref array<AUS_MinigunBarrelController> m_aControllers = {};
+    private ref array<BaseMuzzleComponent> m_aMuzzles = {};
+    private ref array<int> m_aAmmoAtStart = {};
+    private ref array<CharacterControllerComponent> m_aGunners = {};
+    private ref array<bool> m_aGunnerFiring = {};
+    private ref array<int> m_aRplUpdatesAtStart = {};
+    private ref array<int> m_aRplBytesAtStart = {};
+    
+    private bool m_bRunning = false;
+    private bool m_bMeasuring = false;
+    private float m_fElapsed = 0.0;
+    
+    // Frame statistics over the measuring window
+    private int m_iFrames = 0;
+    private float m_fFrameTimeTotal = 0.0;
+    private float m_fFrameTimePeak = 0.0;
+    private int m_iOutputWritesIssuedAtStart = 0;
+    private int m_iOutputWritesSkippedAtStart = 0;
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_MinigunBenchmarkEntity(IEntitySource src, IEntity parent)
+    {
+        SetEventMask(EntityEvent.INIT | EntityEvent.FRAME);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    override protected void EOnInit(IEntity owner)
+    {
+        if (!Replication.IsServer())
+            return;
+        
+        if (m_sVehiclePrefab.IsEmpty() || m_sGunnerPrefab.IsEmpty())
+        {
+            Print("[AUS_MinigunBenchmarkEntity] No vehicle or gunner prefab set", LogLevel.ERROR);
+            return;
+        }
+        
+        SpawnVehicles();
+        
+        Print(string.Format("[AUS_MinigunBenchmarkEntity] Spawned %1 vehicles with %2 minigun controllers and %3 gunners", m_iVehicleCount, m_aControllers.Count(), m_aGunners.Count()), LogLevel.NORMAL);
+        m_bRunning = true;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void SpawnVehicles()
+    {
+        Resource resource = Resource.Load(m_sVehiclePrefab);
+        Resource gunnerResource = Resource.Load(m_sGunnerPrefab);
+        if (!resource.IsValid() || !gunnerResource.IsValid())
+            return;
+        
+        int columns = Math.Ceil(Math.Sqrt(m_iVehicleCount));
+        vector origin = GetOrigin();
+        
+        EntitySpawnParams params = new EntitySpawnParams();
+        params.TransformMode = ETransformMode.WORLD;
+        GetTransform(params.Transform);
+        
+        for (int i = 0; i < m_iVehicleCount; i++)
+        {
+            int row = i / columns;
+            int column = i % columns;
+            params.Transform[3] = origin + Vector(column * m_fSpacing, 0, row * m_fSpacing);
+            
+            IEntity vehicle = GetGame().SpawnEntityPrefab(resource, GetWorld(), params);
+            if (vehicle)
+                CollectControllers(vehicle, vehicle, gunnerResource, params);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Collects the guns of the vehicle and seats a gunner in every turret on the way
+    private void CollectControllers(IEntity entity, IEntity vehicle, Resource gunnerResource, EntitySpawnParams params)
+    {
+        AUS_MinigunBarrelController controller = AUS_MinigunBarrelController.Cast(entity.FindComponent(AUS_MinigunBarrelController));
+        if (controller)
+        {
+            m_aControllers.Insert(controller);
+            m_aMuzzles.Insert(BaseMuzzleComponent.Cast(entity.FindComponent(BaseMuzzleComponent)));
+        }
+        
+        BaseCompartmentManagerComponent compartmentManager = BaseCompartmentManagerComponent.Cast(entity.FindComponent(BaseCompartmentManagerComponent));
+        if (compartmentManager)
+        {
+            array<BaseCompartmentSlot> compartments = {};
+            compartmentManager.GetCompartments(compartments);
+            foreach (BaseCompartmentSlot compartment : compartments)
+            {
+                if (TurretCompartmentSlot.Cast(compartment) && !compartment.GetOccupant())
+                    SeatGunner(vehicle, compartment, gunnerResource, params);
+            }
+        }
+        
+        IEntity child = entity.GetChildren();
+        while (child)
+        {
+            CollectControllers(child, vehicle, gunnerResource, params);
+            child = child.GetSibling();
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void SeatGunner(IEntity vehicle, BaseCompartmentSlot compartment, Resource gunnerResource, EntitySpawnParams params)
+    {
+        IEntity gunner = GetGame().SpawnEntityPrefab(gunnerResource, GetWorld(), params);
+        if (!gunner)
+            return;
+        
+        SCR_CompartmentAccessComponent compartmentAccess = SCR_CompartmentAccessComponent.Cast(gunner.FindComponent(SCR_CompartmentAccessComponent));
+        ChimeraCharacter character = ChimeraCharacter.Cast(gunner);
+        if (!compartmentAccess || !character || !compartmentAccess.MoveInVehicle(vehicle, ECompartmentType.TURRET, true, compartment))
+        {
+            Print("[AUS_MinigunBenchmarkEntity] Cannot seat a gunner in a turret", LogLevel.WARNING);
+            SCR_EntityHelper.DeleteEntityAndChildren(gunner);
+            return;
+        }
+        
+        m_aGunners.Insert(character.GetCharacterController());
+        m_aGunnerFiring.Insert(false);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    override protected void EOnFrame(IEntity owner, float timeSlice)
+    {
+        if (!m_bRunning)
+            return;
+        
+        m_fElapsed += timeSlice;
+        UpdateTriggers();
+        
+        if (!m_bMeasuring)
+        {
+            if (m_fElapsed >= m_fWarmupTime)
+                StartMeasuring();
+            
+            return;
+        }
+        
+        m_iFrames++;
+        m_fFrameTimeTotal += timeSlice;
+        if (timeSlice > m_fFrameTimePeak)
+            m_fFrameTimePeak = timeSlice;
+        
+        if (m_fElapsed >= m_fWarmupTime + m_fMeasureTime)
+            FinishMeasuring();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Gunner i fires for the burst time of every burst + pause cycle, offset by i * stagger
+    private void UpdateTriggers()
+    {
+        int time = m_fElapsed * 1000;
+        int cycle = m_iBurstTime + m_iPauseTime;
+        if (cycle <= 0)
+            return;
+        
+        foreach (int i, CharacterControllerComponent gunner : m_aGunners)
+        {
+            if (!gunner)
+                continue;
+            
+            bool held = ((time + i * m_iStagger) % cycle) < m_iBurstTime;
+            if (held == m_aGunnerFiring[i])
+                continue;
+            
+            gunner.SetFireWeaponWanted(held);
+            m_aGunnerFiring[i] = held;
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void GetAmmoCounts(notnull array<int> outAmmo)
+    {
+        outAmmo.Clear();
+        foreach (BaseMuzzleComponent muzzle : m_aMuzzles)
+        {
+            int ammo = 0;
+            if (muzzle)
+                ammo = muzzle.GetAmmoCount();
+            
+            outAmmo.Insert(ammo);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void StartMeasuring()
+    {
+        m_bMeasuring = true;
+        GetAmmoCounts(m_aAmmoAtStart);
+        
+#ifndef AUS_MINIGUN_BENCHMARK_BASELINE
+        AUS_MinigunBarrelSystem.GetUpdater(GetWorld()).ResetUpdateStats();
+        
+        AUS_MinigunBarrelController.GetTotalOutputWriteCounts(m_iOutputWritesIssuedAtStart, m_iOutputWritesSkippedAtStart);
+        
+        m_aRplUpdatesAtStart.Clear();
+        m_aRplBytesAtStart.Clear();
+        foreach (AUS_MinigunBarrelController controller : m_aControllers)
+        {
+            int updates, bytes;
+            if (controller)
+                controller.GetReplicationEstimate(updates, bytes);
+            
+            m_aRplUpdatesAtStart.Insert(updates);
+            m_aRplBytesAtStart.Insert(bytes);
+        }
+#endif
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void FinishMeasuring()
+    {
+        m_bRunning = false;
+        
+        int controllerCount = m_aControllers.Count();
+        float measured = m_fFrameTimeTotal;
+        if (measured <= 0)
+            measured = 1;
+        
+        // Rounds consumed over the window, belts are not reloaded
+        array<int> ammoAtEnd = {};
+        GetAmmoCounts(ammoAtEnd);
+        int roundsFired = 0;
+        foreach (int gun, int ammo : ammoAtEnd)
+        {
+            roundsFired += Math.Max(m_aAmmoAtStart[gun] - ammo, 0);
+        }
+        
+        float frames = Math.Max(m_iFrames, 1);
+        float weaponSeconds = Math.Max(controllerCount, 1) * measured;
+        
+        array<string> lines = {};
+#ifdef AUS_MINIGUN_BENCHMARK_BASELINE
+        lines.Insert(string.Format("scope=baseline gunners=%1 rounds_fired=%2", m_aGunners.Count(), roundsFired));
+#else
+        lines.Insert(string.Format("scope=weapon gunners=%1 rounds_fired=%2 replication=estimated", m_aGunners.Count(), roundsFired));
+#endif
+        lines.Insert(string.Format("prefab=%1 gunner=%2", m_sVehiclePrefab, m_sGunnerPrefab));
+        lines.Insert(string.Format("vehicles=%1 controllers=%2", m_iVehicleCount, controllerCount));
+        lines.Insert(string.Format("schedule burst_ms=%1 pause_ms=%2 stagger_ms=%3", m_iBurstTime, m_iPauseTime, m_iStagger));
+        lines.Insert(string.Format("measured_s=%1 frames=%2", measured, m_iFrames));
+        lines.Insert(string.Format("frame_ms avg=%1 peak=%2", m_fFrameTimeTotal * 1000 / frames, m_fFrameTimePeak * 1000));
+        lines.Insert(string.Format("rounds_per_weapon_s=%1", roundsFired / weaponSeconds));
+        
+#ifndef AUS_MINIGUN_BENCHMARK_BASELINE
+        int updateFrames, updateTime, peakUpdateTime;
+        AUS_MinigunBarrelSystem.GetUpdater(GetWorld()).GetUpdateStats(updateFrames, updateTime, peakUpdateTime);
+        
+        int writesIssued, writesSkipped;
+        AUS_MinigunBarrelController.GetTotalOutputWriteCounts(writesIssued, writesSkipped);
+        writesIssued -= m_iOutputWritesIssuedAtStart;
+        writesSkipped -= m_iOutputWritesSkippedAtStart;
+        
+        int rplUpdates = 0;
+        int rplBytes = 0;
+        foreach (int i, AUS_MinigunBarrelController controller : m_aControllers)
+        {
+            if (!controller)
+                continue;
+            
+            int updates, bytes;
+            controller.GetReplicationEstimate(updates, bytes);
+            rplUpdates += updates - m_aRplUpdatesAtStart[i];
+            rplBytes += bytes - m_aRplBytesAtStart[i];
+        }
+        
+        lines.Insert(string.Format("controller_ms total=%1 avg_per_frame=%2 peak=%3 active_frames=%4", updateTime, updateTime / frames, peakUpdateTime, updateFrames));
+        lines.Insert(string.Format("output_writes issued=%1 skipped=%2", writesIssued, writesSkipped));
+        lines.Insert(string.Format("replication_estimate updates_per_weapon_s=%1 bytes_per_weapon_s=%2", rplUpdates / weaponSeconds, rplBytes / weaponSeconds));
+#endif
+        
+        FileHandle file = FileIO.OpenFile(m_sSummaryPath, FileMode.WRITE);
+        if (file)
+        {
+            foreach (string line : lines)
+            {
+                file.WriteLine(line);
+            }
+            
+            file.Close();
+        }
+        
+        foreach (string line : lines)
+        {
+            Print("[AUS_MinigunBenchmarkEntity] " + line, LogLevel.NORMAL);
+        }
+        
+        if (m_bQuitWhenDone)
+            GetGame().RequestClose();
+    }
+}
@@ -0,0 +1,92 @@
+// Casing and muzzle flash effects for sustained fire, one continuous emitter each instead of one
+// spawn per round. Both effects are spawned once, attached to the weapon, and emit at their authored
+// birth rate while FIRING; otherwise emission stops. The particle count per gun is therefore bounded
+// by birth rate x lifetime, however long the burst lasts. The authored .ptc birth rates should match
+// sustained fire. Client side only, owned by AUS_MinigunBarrelController and fed from ApplyState, or
+// on remote clients in SIGNALS replication from the replicated firing signal.
+class AUS_MinigunFiringEffects
+{
+    private ParticleEffectEntity m_CasingEffect;
+    private ParticleEffectEntity m_FlashEffect;
+    
+    private bool m_bEmitting = false;
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_MinigunFiringEffects(notnull IEntity owner, ResourceName casingEffect, string casingBone, ResourceName flashEffect, string flashBone)
+    {
+        m_CasingEffect = SpawnEffect(owner, casingEffect, casingBone);
+        m_FlashEffect = SpawnEffect(owner, flashEffect, flashBone);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void ~AUS_MinigunFiringEffects()
+    {
+        if (m_CasingEffect)
+            delete m_CasingEffect;
+        
+        if (m_FlashEffect)
+            delete m_FlashEffect;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Spawned stopped, parented to the bone (or the weapon origin without one)
+    private static ParticleEffectEntity SpawnEffect(IEntity owner, ResourceName effect, string bone)
+    {
+        if (effect.IsEmpty())
+            return null;
+        
+        ParticleEffectEntitySpawnParams spawnParams = new ParticleEffectEntitySpawnParams();
+        spawnParams.TargetWorld = owner.GetWorld();
+        spawnParams.Parent = owner;
+        spawnParams.PlayOnSpawn = false;
+        spawnParams.DeleteWhenStopped = false;
+        
+        Animation animation = owner.GetAnimation();
+        if (animation && !bone.IsEmpty())
+            spawnParams.PivotID = animation.GetBoneIndex(bone);
+        
+        ParticleEffectEntity effectEntity = ParticleEffectEntity.SpawnParticleEffect(effect, spawnParams);
+        if (!effectEntity)
+        {
+            Print(string.Format("[AUS_MinigunFiringEffects] Cannot spawn %1", effect), LogLevel.WARNING);
+            return null;
+        }
+        
+        return effectEntity;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // visible is false for guns culled by the update LOD, which stop emitting as well
+    void Update(AUS_BarrelSpinState state, bool visible)
+    {
+        bool emit = visible && state == AUS_BarrelSpinState.FIRING;
+        if (emit == m_bEmitting)
+            return;
+        
+        if (!emit)
+        {
+            StopEmission();
+            return;
+        }
+        
+        m_bEmitting = true;
+        if (m_CasingEffect)
+            m_CasingEffect.Play();
+        
+        if (m_FlashEffect)
+            m_FlashEffect.Play();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Particles already emitted finish their lifetime
+    private void StopEmission()
+    {
+        m_bEmitting = false;
+        
+        if (m_CasingEffect)
+            m_CasingEffect.StopEmission();
+        
+        if (m_FlashEffect)
+            m_FlashEffect.StopEmission();
+    }
+}
@@ -0,0 +1,252 @@
+// Counters collected for one AUS_MinigunBarrelController while AUS_MinigunProfiler is enabled
+class AUS_MinigunControllerStats
+{
+    string m_sName;
+    int m_iTicks;
+    int m_iDeadZoneSuppressions;
+    int m_iSignalWrites;
+    int m_iAnimationWrites;
+    
+    // Indexed by from * AUS_MinigunProfiler.STATE_COUNT + to
+    ref array<int> m_aTransitions = {};
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_MinigunControllerStats(string name)
+    {
+        m_sName = name;
+        m_aTransitions.Resize(AUS_MinigunProfiler.STATE_COUNT * AUS_MinigunProfiler.STATE_COUNT);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void CountTransition(AUS_BarrelSpinState from, AUS_BarrelSpinState to)
+    {
+        int index = from * AUS_MinigunProfiler.STATE_COUNT + to;
+        m_aTransitions[index] = m_aTransitions[index] + 1;
+    }
+}
+
+// Live instrumentation for the barrel controllers.
+// Everything is gated on s_bEnabled, which callers check before touching any counter, so a disabled
+// profiler costs one static bool read per frame and per output write.
+// Enable it from the diag menu (AUS Minigun > Profile) or with -ausMinigunProfile[=seconds], which
+// also writes the CSV at that interval (default 60 s). ExportCsv can be called at any time.
+class AUS_MinigunProfiler
+{
+    static const string CLI_PARAM = "ausMinigunProfile";
+    static const string CSV_PATH = "$profile:AUS_MinigunProfile.csv";
+    static const int STATE_COUNT = 5;
+    static const float DEFAULT_EXPORT_INTERVAL = 60;
+    
+    // Diag menu IDs, clear of the vanilla SCR_DebugMenuID range
+    static const int DIAG_MENU = 0x7A5100;
+    static const int DIAG_PROFILE = 0x7A5101;
+    static const int DIAG_OVERLAY = 0x7A5102;
+    static const int DIAG_EXPORT = 0x7A5103;
+    
+    static bool s_bEnabled = false;
+    
+    private static ref array<ref AUS_MinigunControllerStats> s_aStats = {};
+    
+    // System totals since the last Reset
+    private static float s_fElapsed = 0;
+    private static int s_iFrames = 0;
+    private static int s_iUpdateTime = 0;
+    private static int s_iPeakUpdateTime = 0;
+    
+    private static float s_fExportInterval = 0;
+    private static float s_fSinceExport = 0;
+    
+    //------------------------------------------------------------------------------------------------
+    // Called once by AUS_MinigunBarrelSystem, or by the fallback updater
+    static void Init()
+    {
+        string interval;
+        if (System.GetCLIParam(CLI_PARAM, interval))
+        {
+            s_fExportInterval = interval.ToFloat();
+            if (s_fExportInterval <= 0)
+                s_fExportInterval = DEFAULT_EXPORT_INTERVAL;
+            
+            SetEnabled(true);
+        }
+        
+#ifdef ENABLE_DIAG
+        DiagMenu.RegisterMenu(DIAG_MENU, "AUS Minigun", "");
+        DiagMenu.RegisterBool(DIAG_PROFILE, "", "Profile", "AUS Minigun");
+        DiagMenu.RegisterBool(DIAG_OVERLAY, "", "Show profile overlay", "AUS Minigun");
+        DiagMenu.RegisterBool(DIAG_EXPORT, "", "Export profile CSV", "AUS Minigun");
+        DiagMenu.SetValue(DIAG_PROFILE, s_bEnabled);
+#endif
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    static void SetEnabled(bool enabled)
+    {
+        if (enabled == s_bEnabled)
+            return;
+        
+        s_bEnabled = enabled;
+        if (enabled)
+            Reset();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Drops all counters. Controllers create fresh stats on their next count.
+    static void Reset()
+    {
+        s_aStats.Clear();
+        s_fElapsed = 0;
+        s_iFrames = 0;
+        s_iUpdateTime = 0;
+        s_iPeakUpdateTime = 0;
+        s_fSinceExport = 0;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    static AUS_MinigunControllerStats CreateStats(string name)
+    {
+        AUS_MinigunControllerStats stats = new AUS_MinigunControllerStats(name);
+        s_aStats.Insert(stats);
+        return stats;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system every frame, also when no controller is awake
+    static void OnFrame(float timeSlice)
+    {
+#ifdef ENABLE_DIAG
+        SetEnabled(DiagMenu.GetBool(DIAG_PROFILE) || s_fExportInterval > 0);
+        
+        if (DiagMenu.GetBool(DIAG_EXPORT))
+        {
+            DiagMenu.SetValue(DIAG_EXPORT, false);
+            ExportCsv();
+        }
+        
+        if (s_bEnabled && DiagMenu.GetBool(DIAG_OVERLAY))
+            DrawOverlay();
+#endif
+        
+        if (!s_bEnabled)
+            return;
+        
+        s_fElapsed += timeSlice;
+        
+        if (s_fExportInterval <= 0)
+            return;
+        
+        s_fSinceExport += timeSlice;
+        if (s_fSinceExport >= s_fExportInterval)
+        {
+            s_fSinceExport = 0;
+            ExportCsv();
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Time (ms) one system update took
+    static void RecordUpdate(int updateTime)
+    {
+        s_iFrames++;
+        s_iUpdateTime += updateTime;
+        if (updateTime > s_iPeakUpdateTime)
+            s_iPeakUpdateTime = updateTime;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static string GetTransitionName(int index)
+    {
+        return typename.EnumToString(AUS_BarrelSpinState, index / STATE_COUNT) + ">" + typename.EnumToString(AUS_BarrelSpinState, index % STATE_COUNT);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Sums every controller's counters into totals
+    private static AUS_MinigunControllerStats GetTotals()
+    {
+        AUS_MinigunControllerStats totals = new AUS_MinigunControllerStats("all");
+        foreach (AUS_MinigunControllerStats stats : s_aStats)
+        {
+            totals.m_iTicks += stats.m_iTicks;
+            totals.m_iDeadZoneSuppressions += stats.m_iDeadZoneSuppressions;
+            totals.m_iSignalWrites += stats.m_iSignalWrites;
+            totals.m_iAnimationWrites += stats.m_iAnimationWrites;
+            
+            foreach (int i, int count : stats.m_aTransitions)
+            {
+                totals.m_aTransitions[i] = totals.m_aTransitions[i] + count;
+            }
+        }
+        
+        return totals;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static void DrawOverlay()
+    {
+        AUS_MinigunControllerStats totals = GetTotals();
+        float elapsed = Math.Max(s_fElapsed, 0.001);
+        float frames = Math.Max(s_iFrames, 1);
+        
+        DbgUI.Begin("AUS Minigun profile");
+        DbgUI.Text(string.Format("controllers %1, %2 s", s_aStats.Count(), elapsed.ToString(-1, 1)));
+        DbgUI.Text(string.Format("ticks/s %1", (totals.m_iTicks / elapsed).ToString(-1, 1)));
+        DbgUI.Text(string.Format("update ms total %1, avg %2, peak %3", s_iUpdateTime, (s_iUpdateTime / frames).ToString(-1, 3), s_iPeakUpdateTime));
+        DbgUI.Text(string.Format("dead-zone suppressions %1", totals.m_iDeadZoneSuppressions));
+        DbgUI.Text(string.Format("writes signal %1, animation %2", totals.m_iSignalWrites, totals.m_iAnimationWrites));
+        
+        foreach (int i, int count : totals.m_aTransitions)
+        {
+            if (count > 0)
+                DbgUI.Text(string.Format("%1 %2", GetTransitionName(i), count));
+        }
+        
+        DbgUI.End();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // One row per controller plus a first "all" row, which alone carries the update timings
+    static bool ExportCsv(string path = CSV_PATH)
+    {
+        FileHandle file = FileIO.OpenFile(path, FileMode.WRITE);
+        if (!file)
+        {
+            Print(string.Format("[AUS_MinigunProfiler] Cannot write %1", path), LogLevel.WARNING);
+            return false;
+        }
+        
+        string header = "name,elapsed_s,ticks,ticks_per_s,update_ms_total,update_ms_peak,deadzone_suppressions,signal_writes,animation_writes";
+        for (int i = 0; i < STATE_COUNT * STATE_COUNT; i++)
+        {
+            if (i / STATE_COUNT != i % STATE_COUNT)
+                header += "," + GetTransitionName(i);
+        }
+        
+        file.WriteLine(header);
+        file.WriteLine(FormatRow(GetTotals(), string.Format("%1,%2", s_iUpdateTime, s_iPeakUpdateTime)));
+        
+        foreach (AUS_MinigunControllerStats stats : s_aStats)
+        {
+            file.WriteLine(FormatRow(stats, ","));
+        }
+        
+        file.Close();
+        Print(string.Format("[AUS_MinigunProfiler] Wrote %1 controllers to %2", s_aStats.Count(), path), LogLevel.NORMAL);
+        return true;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static string FormatRow(AUS_MinigunControllerStats stats, string updateColumns)
+    {
+        float elapsed = Math.Max(s_fElapsed, 0.001);
+        string row = string.Format("%1,%2,%3,%4,%5,%6,%7,%8", stats.m_sName, s_fElapsed, stats.m_iTicks, stats.m_iTicks / elapsed,
+            updateColumns, stats.m_iDeadZoneSuppressions, stats.m_iSignalWrites, stats.m_iAnimationWrites);
+        
+        foreach (int i, int count : stats.m_aTransitions)
+        {
+            if (i / STATE_COUNT != i % STATE_COUNT)
+                row += "," + count;
+        }
+        
+        return row;
+    }
+}
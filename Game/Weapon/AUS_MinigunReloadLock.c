@@ -0,0 +1,42 @@
+// Keeps a turret from reloading while the barrels of its minigun are not IDLE, the reload half of
+// the spin-up gate. The lock itself is kept by AUS_MinigunBarrelController.IsReloadLocked on the
+// authority and on the gunner's client.
+modded class SCR_ReloadTurretAction
+{
+    //------------------------------------------------------------------------------------------------
+    override bool CanBePerformedScript(IEntity user)
+    {
+        AUS_MinigunBarrelController controller = FindMinigunController(GetOwner());
+        if (controller && controller.IsReloadLocked())
+        {
+            SetCannotPerformReason("Barrels spinning");
+            return false;
+        }
+        
+        return super.CanBePerformedScript(user);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The action sits on the turret or on the weapon itself, the weapon is a child of the turret
+    private static AUS_MinigunBarrelController FindMinigunController(IEntity turret)
+    {
+        if (!turret)
+            return null;
+        
+        AUS_MinigunBarrelController controller = AUS_MinigunBarrelController.Cast(turret.FindComponent(AUS_MinigunBarrelController));
+        if (controller)
+            return controller;
+        
+        IEntity child = turret.GetChildren();
+        while (child)
+        {
+            controller = AUS_MinigunBarrelController.Cast(child.FindComponent(AUS_MinigunBarrelController));
+            if (controller)
+                return controller;
+            
+            child = child.GetSibling();
+        }
+        
+        return null;
+    }
+}
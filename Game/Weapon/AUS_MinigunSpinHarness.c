@@ -0,0 +1,248 @@
+// Trigger trace for AUS_MinigunSpinHarness: one firing flag and one time slice per tick
+class AUS_MinigunTrace
+{
+    ref array<bool> m_aFiring = {};
+    ref array<float> m_aTimeSlice = {};
+    
+    //------------------------------------------------------------------------------------------------
+    // Appends ticks of stepMs until durationMs is covered
+    void Hold(bool firing, float durationMs, float stepMs = 16.667)
+    {
+        for (float elapsed = 0; elapsed < durationMs; elapsed += stepMs)
+        {
+            m_aFiring.Insert(firing);
+            m_aTimeSlice.Insert(stepMs * 0.001);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int Count()
+    {
+        return m_aFiring.Count();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Longest tick of the trace (ms)
+    float GetLongestTick()
+    {
+        float longest = 0;
+        foreach (float timeSlice : m_aTimeSlice)
+        {
+            longest = Math.Max(longest, timeSlice * 1000.0);
+        }
+        
+        return longest;
+    }
+}
+
+// Replays trigger traces through AUS_MinigunStateMachine without a world and checks the resulting
+// state sequences, then times the batch update for 1 to 10,000 guns.
+// Runs at game start when the -ausMinigunHarness CLI parameter is given, e.g. on a headless server.
+class AUS_MinigunSpinHarness
+{
+    static const string CLI_PARAM = "ausMinigunHarness";
+    
+    //------------------------------------------------------------------------------------------------
+    // Same values as the AUS_MinigunBarrelControllerClass attribute defaults
+    static AUS_MinigunSpinProfile CreateDefaultProfile()
+    {
+        return new AUS_MinigunSpinProfile(680, 2151, 150, 1750, 150, 500, 2.0, 1.5);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Chain gun on the M230 cycle: 120 ms motor start, 250 ms run-down, 625 rpm, no dead zone
+    static AUS_MinigunSpinProfile CreateChainGunProfile()
+    {
+        return new AUS_MinigunSpinProfile(120, 250, 0, 625, 150, 0, 1.0, 1.0, 0, AUS_WeaponCycle.M230_MOTOR);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Runs the trace on one gun, collecting each state entered and the trace time (ms) it was entered at
+    static void Replay(notnull AUS_MinigunSpinProfile profile, notnull AUS_MinigunTrace trace, notnull array<int> outStates, notnull array<float> outTimes)
+    {
+        AUS_MinigunStateMachine stateMachine = new AUS_MinigunStateMachine();
+        float clock = 0;
+        int currentTime = 0;
+        int gun = stateMachine.Add(profile, currentTime);
+        
+        outStates.Insert(stateMachine.GetState(gun));
+        outTimes.Insert(currentTime);
+        
+        int count = trace.Count();
+        for (int tick = 0; tick < count; tick++)
+        {
+            if (stateMachine.Step(gun, trace.m_aFiring[tick], currentTime, trace.m_aTimeSlice[tick]))
+            {
+                outStates.Insert(stateMachine.GetState(gun));
+                outTimes.Insert(currentTime - stateMachine.GetStateElapsed(gun, currentTime));
+            }
+            
+            clock += trace.m_aTimeSlice[tick] * 1000.0;
+            currentTime = Math.Round(clock);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Expected states must match exactly, and each must be entered within [minTimes, minTimes + window].
+    // Timed transitions carry their overshoot and land on time, input changes are only seen by the
+    // next tick, so the window is one tick, one fixed step and a millisecond of clock rounding.
+    static bool CheckSequence(string name, notnull AUS_MinigunTrace trace, notnull array<int> expectedStates, notnull array<float> minTimes, AUS_MinigunSpinProfile profile = null)
+    {
+        if (!profile)
+            profile = CreateDefaultProfile();
+        
+        array<int> states = {};
+        array<float> times = {};
+        Replay(profile, trace, states, times);
+        
+        float window = trace.GetLongestTick() + profile.GetFixedStep() + 1;
+        bool passed = states.Count() == expectedStates.Count();
+        for (int i = 0; passed && i < states.Count(); i++)
+        {
+            passed = states[i] == expectedStates[i] && times[i] >= minTimes[i] && times[i] <= minTimes[i] + window;
+        }
+        
+        string sequence;
+        foreach (int i, int state : states)
+        {
+            sequence += string.Format(" %1@%2", typename.EnumToString(AUS_BarrelSpinState, state), Math.Round(times[i]));
+        }
+        
+        if (passed)
+            Print(string.Format("[AUS_MinigunSpinHarness] PASS %1:%2", name, sequence), LogLevel.NORMAL);
+        else
+            Print(string.Format("[AUS_MinigunSpinHarness] FAIL %1:%2", name, sequence), LogLevel.ERROR);
+        
+        return passed;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Returns the number of failed scenarios
+    static int RunScenarios()
+    {
+        int failures = 0;
+        AUS_MinigunTrace trace;
+        array<int> expectedStates;
+        array<float> minTimes;
+        
+        // Full burst and release
+        trace = new AUS_MinigunTrace();
+        trace.Hold(true, 1500);
+        trace.Hold(false, 3000);
+        expectedStates = {AUS_BarrelSpinState.IDLE, AUS_BarrelSpinState.SPIN_UP, AUS_BarrelSpinState.READY_TO_FIRE, AUS_BarrelSpinState.FIRING, AUS_BarrelSpinState.SPIN_DOWN, AUS_BarrelSpinState.IDLE};
+        minTimes = {0, 0, 680, 830, 1500, 3651};
+        if (!CheckSequence("burst", trace, expectedStates, minTimes))
+            failures++;
+        
+        // Tap shorter than spin-up, the barrel still finishes spinning up before it spins down
+        trace = new AUS_MinigunTrace();
+        trace.Hold(true, 100);
+        trace.Hold(false, 3500);
+        expectedStates = {AUS_BarrelSpinState.IDLE, AUS_BarrelSpinState.SPIN_UP, AUS_BarrelSpinState.SPIN_DOWN, AUS_BarrelSpinState.IDLE};
+        minTimes = {0, 0, 680, 2831};
+        if (!CheckSequence("tap", trace, expectedStates, minTimes))
+            failures++;
+        
+        // Release right after READY_TO_FIRE is inside the dead zone, so the firing delay runs out first
+        trace = new AUS_MinigunTrace();
+        trace.Hold(true, 700);
+        trace.Hold(false, 3500);
+        expectedStates = {AUS_BarrelSpinState.IDLE, AUS_BarrelSpinState.SPIN_UP, AUS_BarrelSpinState.READY_TO_FIRE, AUS_BarrelSpinState.SPIN_DOWN, AUS_BarrelSpinState.IDLE};
+        minTimes = {0, 0, 680, 830, 2981};
+        if (!CheckSequence("dead zone in ready", trace, expectedStates, minTimes))
+            failures++;
+        
+        // Pressing again during spin-down re-enters spin-up once the dead zone has passed
+        trace = new AUS_MinigunTrace();
+        trace.Hold(true, 1500);
+        trace.Hold(false, 100);
+        trace.Hold(true, 1500);
+        trace.Hold(false, 3000);
+        expectedStates = {AUS_BarrelSpinState.IDLE, AUS_BarrelSpinState.SPIN_UP, AUS_BarrelSpinState.READY_TO_FIRE, AUS_BarrelSpinState.FIRING, AUS_BarrelSpinState.SPIN_DOWN,
+            AUS_BarrelSpinState.SPIN_UP, AUS_BarrelSpinState.READY_TO_FIRE, AUS_BarrelSpinState.FIRING, AUS_BarrelSpinState.SPIN_DOWN, AUS_BarrelSpinState.IDLE};
+        minTimes = {0, 0, 680, 830, 1500, 2000, 2680, 2830, 3100, 5251};
+        if (!CheckSequence("spin-down re-entry", trace, expectedStates, minTimes))
+            failures++;
+        
+        // M230 cycle: fires as soon as the motor is up, restarts the motor straight from run-down
+        trace = new AUS_MinigunTrace();
+        trace.Hold(true, 500);
+        trace.Hold(false, 100);
+        trace.Hold(true, 500);
+        trace.Hold(false, 500);
+        expectedStates = {AUS_BarrelSpinState.IDLE, AUS_BarrelSpinState.SPIN_UP, AUS_BarrelSpinState.FIRING, AUS_BarrelSpinState.SPIN_DOWN,
+            AUS_BarrelSpinState.SPIN_UP, AUS_BarrelSpinState.FIRING, AUS_BarrelSpinState.SPIN_DOWN, AUS_BarrelSpinState.IDLE};
+        minTimes = {0, 0, 120, 500, 600, 720, 1100, 1350};
+        if (!CheckSequence("chain gun cycle", trace, expectedStates, minTimes, CreateChainGunProfile()))
+            failures++;
+        
+        return failures;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Times ticks of gunCount guns firing staggered 2 s bursts every 4 s at 60 Hz
+    static void Benchmark(int gunCount, int ticks)
+    {
+        AUS_MinigunSpinProfile profile = CreateDefaultProfile();
+        AUS_MinigunStateMachine stateMachine = new AUS_MinigunStateMachine();
+        for (int i = 0; i < gunCount; i++)
+        {
+            stateMachine.Add(profile, 0);
+        }
+        
+        float timeSlice = 1.0 / 60.0;
+        float clock = 0;
+        int currentTime = 0;
+        int transitions = 0;
+        
+        int start = System.GetTickCount();
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (int i = 0; i < gunCount; i++)
+            {
+                bool isFiring = ((tick + i * 7) % 240) < 120;
+                if (stateMachine.Step(i, isFiring, currentTime, timeSlice))
+                    transitions++;
+                
+                stateMachine.CalculateSpinSpeed(i);
+            }
+            
+            clock += timeSlice * 1000.0;
+            currentTime = Math.Round(clock);
+        }
+        
+        float elapsed = System.GetTickCount(start);
+        Print(string.Format("[AUS_MinigunSpinHarness] %1 guns x %2 ticks: %3 ms total, %4 ms/tick, %5 us/gun-tick, %6 transitions",
+            gunCount, ticks, elapsed, elapsed / ticks, elapsed * 1000.0 / (ticks * gunCount), transitions), LogLevel.NORMAL);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    static void Run()
+    {
+        int failures = RunScenarios();
+        Print(string.Format("[AUS_MinigunSpinHarness] %1 scenario(s) failed", failures), LogLevel.NORMAL);
+        
+        array<int> gunCounts = {1, 10, 100, 1000, 10000};
+        foreach (int gunCount : gunCounts)
+        {
+            Benchmark(gunCount, 600);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+modded class ArmaReforgerScripted
+{
+    //------------------------------------------------------------------------------------------------
+    override void OnGameStart()
+    {
+        super.OnGameStart();
+        
+        if (System.IsCLIParam(AUS_MinigunSpinHarness.CLI_PARAM))
+            AUS_MinigunSpinHarness.Run();
+        
+        string tracePath;
+        if (System.GetCLIParam(AUS_MinigunTraceReplay.CLI_PARAM, tracePath))
+            AUS_MinigunTraceReplay.Run(tracePath);
+    }
+}
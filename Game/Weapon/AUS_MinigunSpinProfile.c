@@ -0,0 +1,317 @@
+// Barrel tuning shared by every AUS_MinigunBarrelController of a prefab.
+// The spin-up and spin-down curves are sampled once into lookup tables so the per-tick cost
+// is a multiply and a lerp instead of Math.Pow and a division.
+class AUS_MinigunSpinProfile
+{
+    static const int CURVE_SAMPLES = 64;
+    
+    private float m_fSpinUpTime;
+    private float m_fSpinDownTime;
+    private float m_fFiringDelay;
+    private float m_fMaxRPM;
+    private float m_fFireDetectionTolerance;
+    private float m_fTriggerDeadZone;
+    private float m_fSpinUpCurve;
+    private float m_fSpinDownCurve;
+    private int m_iFixedStep;
+    
+    // Update rate LOD, see AUS_BarrelLodTier. Without SetLod every gun is always FULL.
+    private float m_fLodNearDistanceSq = float.MAX;
+    private float m_fLodFarDistanceSq = float.MAX;
+    private int m_iLodInterval = 1;
+    private bool m_bLodCullOffscreen = false;
+    
+    // Network relevance on the authority, by distance to the nearest player. Without SetRelevance
+    // every gun is always FULL.
+    private float m_fRelevanceNearDistanceSq = float.MAX;
+    private float m_fRelevanceFarDistanceSq = float.MAX;
+    private int m_iRelevanceInterval = 1;
+    
+    // State table of the weapon cycle, with the duration of each state resolved from this profile:
+    // -1 for untimed states. Reciprocals are zero when the duration is not positive.
+    private AUS_WeaponStateTable m_StateTable;
+    private ref array<float> m_aStateDuration = {};
+    private ref array<float> m_aInvStateDuration = {};
+    
+    private ref array<float> m_aSpinUpTable = {};
+    private ref array<float> m_aSpinDownTable = {};
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_MinigunSpinProfile(float spinUpTime, float spinDownTime, float firingDelay, float maxRPM, float fireDetectionTolerance, float triggerDeadZone, float spinUpCurve, float spinDownCurve, int fixedStep = 0, AUS_WeaponCycle cycle = AUS_WeaponCycle.M134_SPIN)
+    {
+        m_fSpinUpTime = spinUpTime;
+        m_fSpinDownTime = spinDownTime;
+        m_fFiringDelay = firingDelay;
+        m_fMaxRPM = maxRPM;
+        m_fFireDetectionTolerance = fireDetectionTolerance;
+        m_fTriggerDeadZone = triggerDeadZone;
+        m_fSpinUpCurve = spinUpCurve;
+        m_fSpinDownCurve = spinDownCurve;
+        m_iFixedStep = fixedStep;
+        
+        
+        BuildTables();
+        BuildStateDurations(AUS_WeaponStateTable.Get(cycle));
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Distances in metres, interval in frames
+    void SetLod(float nearDistance, float farDistance, int interval, bool cullOffscreen)
+    {
+        m_fLodNearDistanceSq = nearDistance * nearDistance;
+        m_fLodFarDistanceSq = farDistance * farDistance;
+        m_iLodInterval = Math.Max(interval, 1);
+        m_bLodCullOffscreen = cullOffscreen;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Distances in metres, interval in frames
+    void SetRelevance(float nearDistance, float farDistance, int interval)
+    {
+        m_fRelevanceNearDistanceSq = nearDistance * nearDistance;
+        m_fRelevanceFarDistanceSq = farDistance * farDistance;
+        m_iRelevanceInterval = Math.Max(interval, 1);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static float Reciprocal(float value)
+    {
+        if (value <= 0)
+            return 0.0;
+        
+        return 1.0 / value;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void BuildTables()
+    {
+        m_aSpinUpTable.Resize(CURVE_SAMPLES);
+        m_aSpinDownTable.Resize(CURVE_SAMPLES);
+        
+        float step = 1.0 / (CURVE_SAMPLES - 1);
+        for (int i = 0; i < CURVE_SAMPLES; i++)
+        {
+            float progress = i * step;
+            m_aSpinUpTable[i] = Math.Pow(progress, m_fSpinUpCurve);
+            m_aSpinDownTable[i] = Math.Pow(1.0 - progress, m_fSpinDownCurve);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void BuildStateDurations(notnull AUS_WeaponStateTable stateTable)
+    {
+        m_StateTable = stateTable;
+        m_aStateDuration.Resize(AUS_WeaponStateTable.STATE_COUNT);
+        m_aInvStateDuration.Resize(AUS_WeaponStateTable.STATE_COUNT);
+        
+        for (int state = 0; state < AUS_WeaponStateTable.STATE_COUNT; state++)
+        {
+            float duration = -1.0;
+            switch (stateTable.GetTimer(state))
+            {
+                case AUS_StateTimer.SPIN_UP:
+                    duration = m_fSpinUpTime;
+                    break;
+                
+                case AUS_StateTimer.FIRING_DELAY:
+                    duration = m_fFiringDelay;
+                    break;
+                
+                case AUS_StateTimer.SPIN_DOWN:
+                    duration = m_fSpinDownTime;
+                    break;
+            }
+            
+            m_aStateDuration[state] = duration;
+            m_aInvStateDuration[state] = Reciprocal(duration);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static float SampleTable(array<float> table, float progress)
+    {
+        float position = progress * (CURVE_SAMPLES - 1);
+        int index = Math.Floor(position);
+        if (index >= CURVE_SAMPLES - 1)
+            return table[CURVE_SAMPLES - 1];
+        
+        return Math.Lerp(table[index], table[index + 1], position - index);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Spin speed [0, 1] after stateTimer ms in the state, from the state's output in the table.
+    // Curves over a zero duration jump straight to their end.
+    float SampleSpinSpeed(AUS_BarrelSpinState state, float stateTimer)
+    {
+        switch (m_StateTable.GetOutput(state))
+        {
+            case AUS_StateOutput.RISING:
+                if (m_aInvStateDuration[state] == 0)
+                    return 1.0;
+                
+                return SampleTable(m_aSpinUpTable, GetStateProgress(state, stateTimer));
+            
+            case AUS_StateOutput.FULL:
+                return 1.0;
+            
+            case AUS_StateOutput.FALLING:
+                if (m_aInvStateDuration[state] == 0)
+                    return 0.0;
+                
+                return SampleTable(m_aSpinDownTable, GetStateProgress(state, stateTimer));
+        }
+        
+        return 0.0;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Curve parameters of a state, see AUS_BarrelOutputMode for how they are evaluated
+    void GetStateCurve(AUS_BarrelSpinState state, out float start, out float target, out float duration, out float exponent)
+    {
+        switch (m_StateTable.GetOutput(state))
+        {
+            case AUS_StateOutput.RISING:
+                start = 0.0;
+                target = 1.0;
+                duration = Math.Max(m_aStateDuration[state], 0.0);
+                exponent = m_fSpinUpCurve;
+                return;
+            
+            case AUS_StateOutput.FULL:
+                start = 1.0;
+                target = 1.0;
+                duration = 0.0;
+                exponent = 1.0;
+                return;
+            
+            case AUS_StateOutput.FALLING:
+                start = 1.0;
+                target = 0.0;
+                duration = Math.Max(m_aStateDuration[state], 0.0);
+                exponent = m_fSpinDownCurve;
+                return;
+        }
+        
+        start = 0.0;
+        target = 0.0;
+        duration = 0.0;
+        exponent = 1.0;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Share of the state's duration spent [0, 1], 0 for untimed states
+    float GetStateProgress(AUS_BarrelSpinState state, float stateTimer)
+    {
+        return Math.Clamp(stateTimer * m_aInvStateDuration[state], 0.0, 1.0);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Time (ms) after which the state's timed transitions apply, -1 for untimed states
+    float GetStateDuration(AUS_BarrelSpinState state)
+    {
+        return m_aStateDuration[state];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_WeaponStateTable GetStateTable()
+    {
+        return m_StateTable;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetSpinUpTime()
+    {
+        return m_fSpinUpTime;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetSpinDownTime()
+    {
+        return m_fSpinDownTime;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetFiringDelay()
+    {
+        return m_fFiringDelay;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetMaxRPM()
+    {
+        return m_fMaxRPM;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetFireDetectionTolerance()
+    {
+        return m_fFireDetectionTolerance;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetTriggerDeadZone()
+    {
+        return m_fTriggerDeadZone;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetSpinUpCurve()
+    {
+        return m_fSpinUpCurve;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetSpinDownCurve()
+    {
+        return m_fSpinDownCurve;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // State machine step (ms), 0 advances once per frame by the frame time
+    int GetFixedStep()
+    {
+        return m_iFixedStep;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetLodNearDistanceSq()
+    {
+        return m_fLodNearDistanceSq;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetLodFarDistanceSq()
+    {
+        return m_fLodFarDistanceSq;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetLodInterval()
+    {
+        return m_iLodInterval;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool IsLodCullingOffscreen()
+    {
+        return m_bLodCullOffscreen;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetRelevanceNearDistanceSq()
+    {
+        return m_fRelevanceNearDistanceSq;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetRelevanceFarDistanceSq()
+    {
+        return m_fRelevanceFarDistanceSq;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int GetRelevanceInterval()
+    {
+        return m_iRelevanceInterval;
+    }
+}
@@ -0,0 +1,275 @@
+// Barrel state machine and spin curve for any number of guns, kept in packed parallel arrays.
+// Transitions, timers and output curves come from the AUS_WeaponStateTable of each gun's profile,
+// so one interpreter runs every weapon cycle.
+// Pure script: no components, signals or engine clock. Callers pass in firing intent, the current
+// time as integer monotonic milliseconds and the time slice (s), so the same code runs in
+// AUS_MinigunBarrelUpdater and headless in AUS_MinigunSpinHarness.
+// Absolute times are kept as int so comparisons stay exact however long the server has been up;
+// only the state timer, which restarts on every transition, is a float.
+class AUS_MinigunStateMachine
+{
+    // Age given to "never" timestamps, well past any tolerance or dead zone
+    private static const int LONG_AGO = 1000000;
+    
+    // Most time (ms) split into fixed steps per frame. A longer frame, e.g. a server hitch, advances
+    // the rest in a single step first, so every gun costs a bounded number of steps per frame.
+    private static const float MAX_STEPPED_TIME = 100.0;
+    
+    private ref array<int> m_aState = {};
+    private ref array<float> m_aStateTimer = {};
+    private ref array<float> m_aSpinSpeed = {};
+    private ref array<int> m_aLastFireTime = {};
+    private ref array<int> m_aLastStateChangeTime = {};
+    private ref array<bool> m_aFiring = {};
+    private ref array<float> m_aStepAccumulator = {};
+    
+    // Transitions held back by the trigger dead zone, counted once per suppressed input change
+    private ref array<int> m_aDeadZoneSuppressions = {};
+    private ref array<bool> m_aSuppressing = {};
+    private ref array<AUS_MinigunSpinProfile> m_aProfile = {};
+    
+    //------------------------------------------------------------------------------------------------
+    // Adds an IDLE gun and returns its index
+    int Add(notnull AUS_MinigunSpinProfile profile, int currentTime)
+    {
+        int index = m_aState.Insert(AUS_BarrelSpinState.IDLE);
+        m_aStateTimer.Insert(0.0);
+        m_aSpinSpeed.Insert(0.0);
+        m_aLastFireTime.Insert(currentTime - LONG_AGO);
+        m_aLastStateChangeTime.Insert(currentTime);
+        m_aFiring.Insert(false);
+        m_aStepAccumulator.Insert(0.0);
+        m_aDeadZoneSuppressions.Insert(0);
+        m_aSuppressing.Insert(false);
+        m_aProfile.Insert(profile);
+        
+        return index;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Removes a gun by moving the last one into its index
+    void Remove(int index)
+    {
+        m_aState.Remove(index);
+        m_aStateTimer.Remove(index);
+        m_aSpinSpeed.Remove(index);
+        m_aLastFireTime.Remove(index);
+        m_aLastStateChangeTime.Remove(index);
+        m_aFiring.Remove(index);
+        m_aStepAccumulator.Remove(index);
+        m_aDeadZoneSuppressions.Remove(index);
+        m_aSuppressing.Remove(index);
+        m_aProfile.Remove(index);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    int Count()
+    {
+        return m_aState.Count();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Turns raw inputs into firing intent. A detected shot keeps the gun firing for the profile's
+    // detection tolerance, a held trigger keeps it firing until released.
+    bool ResolveFiring(int i, bool shotDetected, bool triggerHeld, int currentTime)
+    {
+        if (shotDetected)
+            m_aLastFireTime[i] = currentTime;
+        
+        return triggerHeld || (currentTime - m_aLastFireTime[i]) < m_aProfile[i].GetFireDetectionTolerance();
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Advances by one frame. With a fixed step in the profile the frame is split into steps of that
+    // length, carrying the remainder into the next frame, so transitions do not depend on frame rate.
+    // At most ceil(MAX_STEPPED_TIME / fixed step) steps run per frame, plus one for any excess.
+    // Returns true if the state changed.
+    bool Step(int i, bool isFiring, int currentTime, float timeSlice)
+    {
+        int fixedStep = m_aProfile[i].GetFixedStep();
+        if (fixedStep <= 0)
+            return Advance(i, isFiring, currentTime, timeSlice);
+        
+        float accumulator = m_aStepAccumulator[i] + timeSlice * 1000.0;
+        float stepSlice = fixedStep * 0.001;
+        bool changed = false;
+        
+        // The excess keeps its time, a timed transition it runs past carries the overshoot
+        float maxAccumulator = Math.Ceil(MAX_STEPPED_TIME / fixedStep) * fixedStep;
+        if (accumulator > maxAccumulator)
+        {
+            float excess = accumulator - maxAccumulator;
+            if (Advance(i, isFiring, currentTime - Math.Round(accumulator), excess * 0.001))
+                changed = true;
+            
+            accumulator = maxAccumulator;
+        }
+        
+        // Steps are timed from where the previous frame left off
+        while (accumulator >= fixedStep)
+        {
+            int stepTime = currentTime - Math.Round(accumulator);
+            if (Advance(i, isFiring, stepTime, stepSlice))
+                changed = true;
+            
+            accumulator -= fixedStep;
+        }
+        
+        m_aStepAccumulator[i] = accumulator;
+        return changed;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Runs one tick of the state machine. Returns true if the state changed.
+    // Timed transitions carry the overshoot into the new state, so it starts exactly when the
+    // previous one ran out rather than on the tick that noticed.
+    bool Advance(int i, bool isFiring, int currentTime, float timeSlice)
+    {
+        m_aFiring[i] = isFiring;
+        
+        AUS_MinigunSpinProfile profile = m_aProfile[i];
+        AUS_WeaponStateTable table = profile.GetStateTable();
+        int state = m_aState[i];
+        float stateTimer = m_aStateTimer[i];
+        float duration = profile.GetStateDuration(state);
+        float overshoot = 0.0;
+        
+        int index = state * AUS_WeaponStateTable.INPUT_COUNT;
+        if (isFiring)
+            index += AUS_WeaponStateTable.INPUT_FIRING;
+        
+        if (duration >= 0 && stateTimer >= duration)
+        {
+            index += AUS_WeaponStateTable.INPUT_EXPIRED;
+            overshoot = stateTimer - duration;
+        }
+        
+        int nextState = table.GetNextState(index);
+        bool suppressed = false;
+        if (nextState != AUS_WeaponStateTable.STAY && table.IsDeadZoneGuarded(index) && (currentTime - m_aLastStateChangeTime[i]) < profile.GetTriggerDeadZone())
+        {
+            suppressed = true;
+            nextState = AUS_WeaponStateTable.STAY;
+        }
+        
+        if (suppressed && !m_aSuppressing[i])
+            m_aDeadZoneSuppressions[i] = m_aDeadZoneSuppressions[i] + 1;
+        
+        m_aSuppressing[i] = suppressed;
+        
+        bool changed = nextState != AUS_WeaponStateTable.STAY && nextState != state;
+        if (changed)
+            SetState(i, nextState, overshoot, currentTime);
+        
+        m_aStateTimer[i] = m_aStateTimer[i] + timeSlice * 1000.0;
+        return changed;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Advances the state timer only, for guns whose transitions come from elsewhere
+    void AdvanceTimer(int i, float timeSlice)
+    {
+        m_aStateTimer[i] = m_aStateTimer[i] + timeSlice * 1000.0;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Forces a state, elapsed is the time already spent in it (ms)
+    void SetState(int i, AUS_BarrelSpinState state, float elapsed, int currentTime)
+    {
+        m_aState[i] = state;
+        m_aStateTimer[i] = elapsed;
+        m_aLastStateChangeTime[i] = currentTime - Math.Round(elapsed);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void CalculateSpinSpeed(int i)
+    {
+        m_aSpinSpeed[i] = m_aProfile[i].SampleSpinSpeed(m_aState[i], m_aStateTimer[i]);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_BarrelSpinState GetState(int i)
+    {
+        return m_aState[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetStateTimer(int i)
+    {
+        return m_aStateTimer[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Fixed-step time (ms) carried into the next frame, 0 without a fixed step
+    float GetStepAccumulator(int i)
+    {
+        return m_aStepAccumulator[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void SetStepAccumulator(int i, float accumulator)
+    {
+        m_aStepAccumulator[i] = accumulator;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True if the trigger dead zone held back a transition on the last tick
+    bool IsSuppressing(int i)
+    {
+        return m_aSuppressing[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Time (ms) since the last detected shot
+    int GetTimeSinceFire(int i, int currentTime)
+    {
+        return currentTime - m_aLastFireTime[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void SetTimeSinceFire(int i, int timeSinceFire, int currentTime)
+    {
+        m_aLastFireTime[i] = currentTime - timeSinceFire;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Time (ms) since the current state was entered
+    int GetStateElapsed(int i, int currentTime)
+    {
+        return currentTime - m_aLastStateChangeTime[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Spin speed as of the last CalculateSpinSpeed
+    float GetSpinSpeed(int i)
+    {
+        return m_aSpinSpeed[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Dead-zone suppressions since the last call
+    int ConsumeDeadZoneSuppressions(int i)
+    {
+        int suppressions = m_aDeadZoneSuppressions[i];
+        m_aDeadZoneSuppressions[i] = 0;
+        return suppressions;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_MinigunSpinProfile GetProfile(int i)
+    {
+        return m_aProfile[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool IsFiring(int i)
+    {
+        return m_aFiring[i];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    float GetStateProgress(int i)
+    {
+        return m_aProfile[i].GetStateProgress(m_aState[i], m_aStateTimer[i]);
+    }
+}
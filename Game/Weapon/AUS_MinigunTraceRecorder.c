@@ -0,0 +1,295 @@
+// Fixed-size ring buffer of one controller's state machine ticks, packed four ints per tick:
+//   [0] tick time (ms)
+//   [1] bits 0-15 time slice (10 us units), 16-22 ammo delta + 64, 23 shot detected, 24 trigger held,
+//       25 firing intent, 26-28 state after the tick
+//   [2] bits 0-27 state timer before the tick (ms), 28-30 state before the tick
+//   [3] fixed-step accumulator before the tick (10 us units)
+// Recording is a handful of shifts and four array writes per tick, cheap enough to leave on.
+// The buffer is dumped to a binary file on demand (AUS_MinigunBarrelController.DumpTrace) and on
+// anomalies, and AUS_MinigunTraceReplay feeds a dump back through AUS_MinigunStateMachine offline.
+// Anomaly dumps are rate limited per recorder and across all recorders.
+class AUS_MinigunTraceRecorder
+{
+    static const int FILE_MAGIC = 0x54535541; // "AUST"
+    static const int FILE_VERSION = 3;
+    static const int RECORD_INTS = 4;
+    
+    // Minimum time between automatic dumps of one recorder (ms)
+    private static const int ANOMALY_DUMP_COOLDOWN = 10000;
+    // Minimum time between automatic dumps of all recorders together (ms)
+    private static const int GLOBAL_DUMP_COOLDOWN = 30000;
+    // Held trigger that has not reached FIRING after spin-up + firing delay + this much (ms)
+    private static const int STALL_MARGIN = 250;
+    // Rounds still reported this long after leaving FIRING were fired before the gate closed (ms)
+    private static const int GATE_CLOSE_MARGIN = 100;
+    
+    private static int s_iDumpCount = 0;
+    private static int s_iLastAutoDumpTime;
+    private static bool s_bAutoDumped = false;
+    
+    private ref array<int> m_aBuffer = {};
+    private AUS_MinigunSpinProfile m_Profile;
+    private int m_iCapacity;
+    private int m_iHead = 0;
+    private int m_iCount = 0;
+    
+    // Anomaly tracking
+    private int m_iTriggerHeldSince = -1;
+    private bool m_bStallReported = false;
+    private int m_iLastFiringTime = -1;
+    private int m_iLastDumpTime;
+    private bool m_bDumped = false;
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_MinigunTraceRecorder(notnull AUS_MinigunSpinProfile profile, int capacity)
+    {
+        m_Profile = profile;
+        m_iCapacity = Math.Max(capacity, 1);
+        m_aBuffer.Resize(m_iCapacity * RECORD_INTS);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Called by the system after each state machine tick of the controller
+    // gated: the muzzle gate holds the gun outside FIRING. deadZoneHeld: the trigger dead zone held
+    // back a transition on this tick.
+    void Record(int tickTime, float timeSlice, int ammoDelta, bool shotDetected, bool triggerHeld, bool isFiring,
+        AUS_BarrelSpinState stateBefore, float timerBefore, float accumulatorBefore, AUS_BarrelSpinState stateAfter, bool gated, bool deadZoneHeld)
+    {
+        int flags = Math.ClampInt(timeSlice * 100000, 0, 0xFFFF);
+        flags |= Math.ClampInt(ammoDelta + 64, 0, 127) << 16;
+        if (shotDetected)
+            flags |= 1 << 23;
+        
+        if (triggerHeld)
+            flags |= 1 << 24;
+        
+        if (isFiring)
+            flags |= 1 << 25;
+        
+        flags |= stateAfter << 26;
+        
+        int timer = timerBefore;
+        
+        int index = m_iHead * RECORD_INTS;
+        m_aBuffer[index] = tickTime;
+        m_aBuffer[index + 1] = flags;
+        m_aBuffer[index + 2] = Math.ClampInt(timer, 0, 0x0FFFFFFF) | (stateBefore << 28);
+        m_aBuffer[index + 3] = Math.Round(accumulatorBefore * 100);
+        
+        m_iHead = (m_iHead + 1) % m_iCapacity;
+        if (m_iCount < m_iCapacity)
+            m_iCount++;
+        
+        CheckAnomalies(tickTime, ammoDelta, triggerHeld, stateBefore, stateAfter, gated, deadZoneHeld);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private void CheckAnomalies(int tickTime, int ammoDelta, bool triggerHeld, AUS_BarrelSpinState stateBefore, AUS_BarrelSpinState state, bool gated, bool deadZoneHeld)
+    {
+        string anomaly;
+        
+        if (stateBefore == AUS_BarrelSpinState.FIRING || state == AUS_BarrelSpinState.FIRING)
+            m_iLastFiringTime = tickTime;
+        
+        // Rounds leaving a gated barrel well after FIRING. Ungated guns fire before spin-up by design,
+        // and while the dead zone holds the state it lags the trigger on purpose.
+        if (gated && !deadZoneHeld && ammoDelta < 0 && (m_iLastFiringTime == -1 || tickTime - m_iLastFiringTime > GATE_CLOSE_MARGIN))
+            anomaly = "shot while barrel disengaged";
+        
+        // Trigger held well past the time FIRING should have been reached
+        if (triggerHeld && state != AUS_BarrelSpinState.FIRING)
+        {
+            if (m_iTriggerHeldSince == -1)
+                m_iTriggerHeldSince = tickTime;
+            
+            float limit = m_Profile.GetSpinUpTime() + m_Profile.GetFiringDelay() + STALL_MARGIN;
+            if (!m_bStallReported && tickTime - m_iTriggerHeldSince > limit)
+            {
+                m_bStallReported = true;
+                anomaly = "trigger held without reaching FIRING";
+            }
+        }
+        else
+        {
+            m_iTriggerHeldSince = -1;
+            m_bStallReported = false;
+        }
+        
+        if (anomaly.IsEmpty())
+            return;
+        
+        if (m_bDumped && tickTime - m_iLastDumpTime < ANOMALY_DUMP_COOLDOWN)
+            return;
+        
+        if (s_bAutoDumped && tickTime - s_iLastAutoDumpTime < GLOBAL_DUMP_COOLDOWN)
+            return;
+        
+        m_bDumped = true;
+        m_iLastDumpTime = tickTime;
+        s_bAutoDumped = true;
+        s_iLastAutoDumpTime = tickTime;
+        Dump(anomaly);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Writes the buffer oldest first, returns the file path or an empty string on failure
+    string Dump(string reason)
+    {
+        s_iDumpCount++;
+        string path = string.Format("$profile:AUS_MinigunTrace_%1_%2.bin", System.GetTickCount(), s_iDumpCount);
+        
+        FileHandle file = FileIO.OpenFile(path, FileMode.WRITE);
+        if (!file)
+        {
+            Print(string.Format("[AUS_MinigunTraceRecorder] Cannot write %1", path), LogLevel.WARNING);
+            return string.Empty;
+        }
+        
+        file.Write(FILE_MAGIC, 4);
+        file.Write(FILE_VERSION, 4);
+        
+        // Tuning, so the replay runs the same profile
+        file.Write(m_Profile.GetSpinUpTime(), 4);
+        file.Write(m_Profile.GetSpinDownTime(), 4);
+        file.Write(m_Profile.GetFiringDelay(), 4);
+        file.Write(m_Profile.GetMaxRPM(), 4);
+        file.Write(m_Profile.GetFireDetectionTolerance(), 4);
+        file.Write(m_Profile.GetTriggerDeadZone(), 4);
+        file.Write(m_Profile.GetSpinUpCurve(), 4);
+        file.Write(m_Profile.GetSpinDownCurve(), 4);
+        file.Write(m_Profile.GetFixedStep(), 4);
+        file.Write(m_Profile.GetStateTable().GetCycle(), 4);
+        
+        file.Write(m_iCount, 4);
+        
+        int first = (m_iHead - m_iCount + m_iCapacity) % m_iCapacity;
+        for (int n = 0; n < m_iCount; n++)
+        {
+            int index = ((first + n) % m_iCapacity) * RECORD_INTS;
+            file.Write(m_aBuffer[index], 4);
+            file.Write(m_aBuffer[index + 1], 4);
+            file.Write(m_aBuffer[index + 2], 4);
+            file.Write(m_aBuffer[index + 3], 4);
+        }
+        
+        file.Close();
+        Print(string.Format("[AUS_MinigunTraceRecorder] %1: wrote %2 ticks to %3", reason, m_iCount, path), LogLevel.WARNING);
+        return path;
+    }
+}
+
+// Feeds a trace dump back through AUS_MinigunStateMachine and reports every tick whose state differs
+// from the recorded one. Runs at game start with -ausMinigunReplay=<path>.
+class AUS_MinigunTraceReplay
+{
+    static const string CLI_PARAM = "ausMinigunReplay";
+    
+    //------------------------------------------------------------------------------------------------
+    private static int ReadInt(FileHandle file)
+    {
+        int value;
+        file.Read(value, 4);
+        return value;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static float ReadFloat(FileHandle file)
+    {
+        float value;
+        file.Read(value, 4);
+        return value;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Sets the gun to the state, timer and accumulator recorded before tick n, as of currentTime
+    private static void SyncToRecord(AUS_MinigunStateMachine stateMachine, int gun, array<int> records, int n, int currentTime)
+    {
+        int index = n * AUS_MinigunTraceRecorder.RECORD_INTS;
+        int before = records[index + 2];
+        stateMachine.SetState(gun, before >> 28, before & 0x0FFFFFFF, currentTime);
+        stateMachine.SetStepAccumulator(gun, records[index + 3] * 0.01);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Returns the number of mismatching ticks, -1 if the file cannot be read
+    static int Run(string path)
+    {
+        FileHandle file = FileIO.OpenFile(path, FileMode.READ);
+        if (!file)
+        {
+            Print(string.Format("[AUS_MinigunTraceReplay] Cannot open %1", path), LogLevel.ERROR);
+            return -1;
+        }
+        
+        if (ReadInt(file) != AUS_MinigunTraceRecorder.FILE_MAGIC || ReadInt(file) != AUS_MinigunTraceRecorder.FILE_VERSION)
+        {
+            file.Close();
+            Print(string.Format("[AUS_MinigunTraceReplay] %1 is not a trace dump", path), LogLevel.ERROR);
+            return -1;
+        }
+        
+        float spinUpTime = ReadFloat(file);
+        float spinDownTime = ReadFloat(file);
+        float firingDelay = ReadFloat(file);
+        float maxRPM = ReadFloat(file);
+        float tolerance = ReadFloat(file);
+        float deadZone = ReadFloat(file);
+        float spinUpCurve = ReadFloat(file);
+        float spinDownCurve = ReadFloat(file);
+        int fixedStep = ReadInt(file);
+        AUS_WeaponCycle cycle = ReadInt(file);
+        AUS_MinigunSpinProfile profile = new AUS_MinigunSpinProfile(spinUpTime, spinDownTime, firingDelay, maxRPM, tolerance, deadZone, spinUpCurve, spinDownCurve, fixedStep, cycle);
+        
+        int count = ReadInt(file);
+        array<int> records = {};
+        records.Resize(count * AUS_MinigunTraceRecorder.RECORD_INTS);
+        for (int i = 0; i < records.Count(); i++)
+        {
+            records[i] = ReadInt(file);
+        }
+        
+        file.Close();
+        
+        if (count == 0)
+            return 0;
+        
+        // Start from the state recorded before the oldest tick. The last shot before the buffer is
+        // unknown, so the first ticks may differ within the detection tolerance.
+        AUS_MinigunStateMachine stateMachine = new AUS_MinigunStateMachine();
+        int gun = stateMachine.Add(profile, records[0]);
+        SyncToRecord(stateMachine, gun, records, 0, records[0]);
+        
+        int mismatches = 0;
+        for (int n = 0; n < count; n++)
+        {
+            int index = n * AUS_MinigunTraceRecorder.RECORD_INTS;
+            int tickTime = records[index];
+            int flags = records[index + 1];
+            
+            float timeSlice = (flags & 0xFFFF) * 0.00001;
+            bool shotDetected = flags & (1 << 23);
+            bool triggerHeld = flags & (1 << 24);
+            AUS_BarrelSpinState recordedState = (flags >> 26) & 0x7;
+            
+            bool isFiring = stateMachine.ResolveFiring(gun, shotDetected, triggerHeld, tickTime);
+            stateMachine.Step(gun, isFiring, tickTime, timeSlice);
+            
+            AUS_BarrelSpinState replayedState = stateMachine.GetState(gun);
+            if (replayedState != recordedState)
+            {
+                mismatches++;
+                Print(string.Format("[AUS_MinigunTraceReplay] tick %1 at %2 ms: recorded %3, replayed %4 (ammo delta %5, shot %6, trigger %7)", n, tickTime,
+                    typename.EnumToString(AUS_BarrelSpinState, recordedState), typename.EnumToString(AUS_BarrelSpinState, replayedState),
+                    ((flags >> 16) & 0x7F) - 64, shotDetected, triggerHeld), LogLevel.WARNING);
+                
+                // Follow the recording so one divergence is reported once, from the state, timer and
+                // accumulator the next tick started with
+                if (n + 1 < count)
+                    SyncToRecord(stateMachine, gun, records, n + 1, tickTime);
+            }
+        }
+        
+        Print(string.Format("[AUS_MinigunTraceReplay] %1: %2 ticks, %3 mismatches", path, count, mismatches), LogLevel.NORMAL);
+        return mismatches;
+    }
+}
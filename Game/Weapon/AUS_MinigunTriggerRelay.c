@@ -0,0 +1,25 @@
+// Carries a client gunner's trigger to the server. A turret gunner does not own the weapon's
+// RplComponent, so the barrel controller cannot send server RPCs itself; the player controller is
+// owned by the client and relays the input to AUS_MinigunBarrelController.SetGunnerTriggerHeld.
+modded class SCR_PlayerController
+{
+    //------------------------------------------------------------------------------------------------
+    void AUS_AskSetMinigunTrigger(RplId weaponId, bool held)
+    {
+        Rpc(AUS_RpcAsk_SetMinigunTrigger, weaponId, held);
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The controller only accepts the input if the sender's character is its seated gunner
+    [RplRpc(RplChannel.Reliable, RplRcver.Server)]
+    protected void AUS_RpcAsk_SetMinigunTrigger(RplId weaponId, bool held)
+    {
+        RplComponent rplComponent = RplComponent.Cast(Replication.FindItem(weaponId));
+        if (!rplComponent)
+            return;
+        
+        AUS_MinigunBarrelController controller = AUS_MinigunBarrelController.Cast(rplComponent.GetEntity().FindComponent(AUS_MinigunBarrelController));
+        if (controller)
+            controller.SetGunnerTriggerHeld(GetControlledEntity(), held);
+    }
+}
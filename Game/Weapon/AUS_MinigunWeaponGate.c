@@ -0,0 +1,62 @@
+// Holds a muzzle on its Safety fire mode while the barrel is not yet FIRING, so the engine spawns,
+// simulates and replicates no rounds during spin-up. The muzzle needs a fire mode of type
+// EWeaponFiremodeType.Safety; without one the gate is unavailable and the weapon fires freely.
+class AUS_MinigunWeaponGate
+{
+    private BaseMuzzleComponent m_Muzzle;
+    private int m_iSafetyFireMode = -1;
+    private int m_iReleasedFireMode = -1;
+    private bool m_bBlocked = false;
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_MinigunWeaponGate(notnull BaseMuzzleComponent muzzle)
+    {
+        m_Muzzle = muzzle;
+        
+        array<BaseFireMode> fireModes = {};
+        muzzle.GetFireModesList(fireModes);
+        foreach (int i, BaseFireMode fireMode : fireModes)
+        {
+            if (fireMode.GetFiremodeType() == EWeaponFiremodeType.Safety)
+            {
+                m_iSafetyFireMode = i;
+                break;
+            }
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool IsAvailable()
+    {
+        return m_iSafetyFireMode != -1;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Switches to Safety, remembering the fire mode to return to
+    void SetBlocked(bool blocked)
+    {
+        if (blocked == m_bBlocked || !IsAvailable())
+            return;
+        
+        m_bBlocked = blocked;
+        
+        if (blocked)
+        {
+            int current = m_Muzzle.GetCurrentFireModeIndex();
+            if (current != m_iSafetyFireMode)
+                m_iReleasedFireMode = current;
+            
+            m_Muzzle.SetFireMode(m_iSafetyFireMode);
+        }
+        else if (m_iReleasedFireMode != -1)
+        {
+            m_Muzzle.SetFireMode(m_iReleasedFireMode);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    bool IsBlocked()
+    {
+        return m_bBlocked;
+    }
+}
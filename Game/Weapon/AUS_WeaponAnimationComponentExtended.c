@@ -1,77 +1,283 @@
 class AUS_WeaponAnimationComponentClass: WeaponAnimationComponentClass
 {
+    // Variable IDs bound by any instance of this prefab. Every instance runs the same animation
+    // graph, so a name only has to be bound once.
+    ref map<string, int> m_SharedFloatIds = new map<string, int>();
+    ref map<string, int> m_SharedIntIds = new map<string, int>();
+    ref map<string, int> m_SharedBoolIds = new map<string, int>();
+    
+    bool m_bInitializationLogged = false;
+}
+
+// Animation variables bound together by AUS_WeaponAnimationComponent.BindVariableSet.
+// Values are staged by index and written by CommitVariableSet, which skips values that have not
+// changed since the last commit. Up to MAX_VARIABLES of each type.
+class AUS_AnimationVariableSet
+{
+    static const int MAX_VARIABLES = 32;
+    
+    // Variable IDs in bind order, -1 where the graph has no such variable
+    ref array<int> m_aFloatIds = {};
+    ref array<int> m_aIntIds = {};
+    ref array<int> m_aBoolIds = {};
+    
+    // Staged values and one dirty bit per index
+    ref array<float> m_aFloatValues = {};
+    ref array<int> m_aIntValues = {};
+    ref array<bool> m_aBoolValues = {};
+    int m_iFloatDirty;
+    int m_iIntDirty;
+    int m_iBoolDirty;
+    
+    // Values as of the last commit
+    ref array<float> m_aFloatCommitted = {};
+    ref array<int> m_aIntCommitted = {};
+    ref array<bool> m_aBoolCommitted = {};
+    
+    //------------------------------------------------------------------------------------------------
+    void SetFloat(int index, float value)
+    {
+        m_aFloatValues[index] = value;
+        m_iFloatDirty |= 1 << index;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void SetInt(int index, int value)
+    {
+        m_aIntValues[index] = value;
+        m_iIntDirty |= 1 << index;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void SetBool(int index, bool value)
+    {
+        m_aBoolValues[index] = value;
+        m_iBoolDirty |= 1 << index;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Forgets the committed values, so the next commit writes everything staged
+    void Invalidate()
+    {
+        for (int i = 0; i < m_aFloatCommitted.Count(); i++)
+        {
+            m_aFloatCommitted[i] = float.MAX;
+        }
+        
+        for (int i = 0; i < m_aIntCommitted.Count(); i++)
+        {
+            m_aIntCommitted[i] = int.MAX;
+        }
+        
+        for (int i = 0; i < m_aBoolCommitted.Count(); i++)
+        {
+            m_aBoolCommitted[i] = !m_aBoolValues[i];
+        }
+    }
 }
 
 class AUS_WeaponAnimationComponent: WeaponAnimationComponent
 {
-    // Variable ID storage for efficient access
-    private ref map<string, int> m_VariableFloatIds = new map<string, int>();
-    private ref map<string, int> m_VariableIntIds = new map<string, int>();
-    private ref map<string, int> m_VariableBoolIds = new map<string, int>();
+    // Variable ID storage for efficient access. Shared through the prefab data when there is
+    // any, otherwise created on first bind.
+    private ref map<string, int> m_VariableFloatIds;
+    private ref map<string, int> m_VariableIntIds;
+    private ref map<string, int> m_VariableBoolIds;
     
     private bool m_bInitialized = false;
     
     //------------------------------------------------------------------------------------------------
     private void CheckInitialization()
     {
-        if (!m_bInitialized)
+        if (m_bInitialized)
+            return;
+        
+        m_bInitialized = true;
+        
+        AUS_WeaponAnimationComponentClass prefabData;
+        IEntity owner = GetOwner();
+        if (owner)
+            prefabData = AUS_WeaponAnimationComponentClass.Cast(GetComponentData(owner));
+        
+        if (prefabData)
+        {
+            m_VariableFloatIds = prefabData.m_SharedFloatIds;
+            m_VariableIntIds = prefabData.m_SharedIntIds;
+            m_VariableBoolIds = prefabData.m_SharedBoolIds;
+            
+            if (prefabData.m_bInitializationLogged)
+                return;
+            
+            prefabData.m_bInitializationLogged = true;
+        }
+        else
         {
-            m_bInitialized = true;
-            Print("[AUS_WeaponAnimationComponent] Component initialized successfully", LogLevel.NORMAL);
+            m_VariableFloatIds = new map<string, int>();
+            m_VariableIntIds = new map<string, int>();
+            m_VariableBoolIds = new map<string, int>();
         }
+        
+        Print("[AUS_WeaponAnimationComponent] Component initialized successfully", LogLevel.NORMAL);
     }
     
     //------------------------------------------------------------------------------------------------
-    // Bind a float variable and return its ID for efficient access
+    // Bind a float variable and return its ID for efficient access.
+    // Only successful binds are cached: the maps are shared by the prefab, and a bind attempted
+    // before the graph is ready must not disable the variable for every instance.
     int BindVariableFloat(string variableName)
     {
         CheckInitialization();
         
-        if (m_VariableFloatIds.Contains(variableName))
-            return m_VariableFloatIds.Get(variableName);
+        int variableId;
+        if (m_VariableFloatIds.Find(variableName, variableId))
+            return variableId;
             
-        int variableId = BindFloatVariable(variableName);
+        variableId = BindFloatVariable(variableName);
         if (variableId != -1)
-        {
             m_VariableFloatIds.Set(variableName, variableId);
-            return variableId;
-        }
         
-        return -1;
+        return variableId;
     }
     
     //------------------------------------------------------------------------------------------------
     // Bind an int variable and return its ID for efficient access
     int BindVariableInt(string variableName)
     {
-        if (m_VariableIntIds.Contains(variableName))
-            return m_VariableIntIds.Get(variableName);
+        CheckInitialization();
+        
+        int variableId;
+        if (m_VariableIntIds.Find(variableName, variableId))
+            return variableId;
             
-        int variableId = BindIntVariable(variableName);
+        variableId = BindIntVariable(variableName);
         if (variableId != -1)
-        {
             m_VariableIntIds.Set(variableName, variableId);
-            return variableId;
-        }
         
-        return -1;
+        return variableId;
     }
     
     //------------------------------------------------------------------------------------------------
     // Bind a bool variable and return its ID for efficient access
     int BindVariableBool(string variableName)
     {
-        if (m_VariableBoolIds.Contains(variableName))
-            return m_VariableBoolIds.Get(variableName);
+        CheckInitialization();
+        
+        int variableId;
+        if (m_VariableBoolIds.Find(variableName, variableId))
+            return variableId;
             
-        int variableId = BindBoolVariable(variableName);
+        variableId = BindBoolVariable(variableName);
         if (variableId != -1)
-        {
             m_VariableBoolIds.Set(variableName, variableId);
-            return variableId;
+        
+        return variableId;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Bind lists of variables in one call. Stage values on the returned set by list index and
+    // write them with CommitVariableSet.
+    AUS_AnimationVariableSet BindVariableSet(array<string> floatNames, array<string> intNames = null, array<string> boolNames = null)
+    {
+        AUS_AnimationVariableSet variableSet = new AUS_AnimationVariableSet();
+        
+        if (floatNames)
+        {
+            foreach (int i, string name : floatNames)
+            {
+                if (i >= AUS_AnimationVariableSet.MAX_VARIABLES)
+                    break;
+                
+                variableSet.m_aFloatIds.Insert(BindVariableFloat(name));
+                variableSet.m_aFloatValues.Insert(0.0);
+                variableSet.m_aFloatCommitted.Insert(0.0);
+            }
+        }
+        
+        if (intNames)
+        {
+            foreach (int i, string name : intNames)
+            {
+                if (i >= AUS_AnimationVariableSet.MAX_VARIABLES)
+                    break;
+                
+                variableSet.m_aIntIds.Insert(BindVariableInt(name));
+                variableSet.m_aIntValues.Insert(0);
+                variableSet.m_aIntCommitted.Insert(0);
+            }
+        }
+        
+        if (boolNames)
+        {
+            foreach (int i, string name : boolNames)
+            {
+                if (i >= AUS_AnimationVariableSet.MAX_VARIABLES)
+                    break;
+                
+                variableSet.m_aBoolIds.Insert(BindVariableBool(name));
+                variableSet.m_aBoolValues.Insert(false);
+                variableSet.m_aBoolCommitted.Insert(false);
+            }
+        }
+        
+        variableSet.Invalidate();
+        return variableSet;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Writes every staged value that differs from the last commit. Returns the number of writes.
+    int CommitVariableSet(notnull AUS_AnimationVariableSet variableSet)
+    {
+        int writes = 0;
+        
+        if (variableSet.m_iFloatDirty)
+        {
+            foreach (int i, int variableId : variableSet.m_aFloatIds)
+            {
+                float value = variableSet.m_aFloatValues[i];
+                if (!(variableSet.m_iFloatDirty & (1 << i)) || variableId == -1 || value == variableSet.m_aFloatCommitted[i])
+                    continue;
+                
+                SetFloatVariable(variableId, value);
+                variableSet.m_aFloatCommitted[i] = value;
+                writes++;
+            }
+            
+            variableSet.m_iFloatDirty = 0;
+        }
+        
+        if (variableSet.m_iIntDirty)
+        {
+            foreach (int i, int variableId : variableSet.m_aIntIds)
+            {
+                int value = variableSet.m_aIntValues[i];
+                if (!(variableSet.m_iIntDirty & (1 << i)) || variableId == -1 || value == variableSet.m_aIntCommitted[i])
+                    continue;
+                
+                SetIntVariable(variableId, value);
+                variableSet.m_aIntCommitted[i] = value;
+                writes++;
+            }
+            
+            variableSet.m_iIntDirty = 0;
+        }
+        
+        if (variableSet.m_iBoolDirty)
+        {
+            foreach (int i, int variableId : variableSet.m_aBoolIds)
+            {
+                bool value = variableSet.m_aBoolValues[i];
+                if (!(variableSet.m_iBoolDirty & (1 << i)) || variableId == -1 || value == variableSet.m_aBoolCommitted[i])
+                    continue;
+                
+                SetBoolVariable(variableId, value);
+                variableSet.m_aBoolCommitted[i] = value;
+                writes++;
+            }
+            
+            variableSet.m_iBoolDirty = 0;
         }
         
-        return -1;
+        return writes;
     }
     
     //------------------------------------------------------------------------------------------------
@@ -105,7 +311,7 @@ class AUS_WeaponAnimationComponent: WeaponAnimationComponent
     }
     
     //------------------------------------------------------------------------------------------------
-    // Set float variable by name (less efficient - finds ID each time)
+    // Set float variable by name (one map lookup once bound)
     void SetVariableFloatByName(string variableName, float value)
     {
         int variableId = BindVariableFloat(variableName);
@@ -113,7 +319,7 @@ class AUS_WeaponAnimationComponent: WeaponAnimationComponent
     }
     
     //------------------------------------------------------------------------------------------------
-    // Set int variable by name (less efficient - finds ID each time)
+    // Set int variable by name (one map lookup once bound)
     void SetVariableIntByName(string variableName, int value)
     {
         int variableId = BindVariableInt(variableName);
@@ -121,7 +327,7 @@ class AUS_WeaponAnimationComponent: WeaponAnimationComponent
     }
     
     //------------------------------------------------------------------------------------------------
-    // Set bool variable by name (less efficient - finds ID each time)
+    // Set bool variable by name (one map lookup once bound)
     void SetVariableBoolByName(string variableName, bool value)
     {
         int variableId = BindVariableBool(variableName);
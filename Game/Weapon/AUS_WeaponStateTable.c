@@ -0,0 +1,208 @@
+// Weapon cycles with a state table, picked per prefab on AUS_MinigunBarrelControllerClass
+enum AUS_WeaponCycle
+{
+    M134_SPIN = 0,  // Barrel spin-up, firing delay, free spin-down
+    M230_MOTOR = 1  // Chain gun: motor start, firing, bolt run-down. READY_TO_FIRE is unused.
+}
+
+// Profile duration that times a state, see AUS_MinigunSpinProfile.GetStateDuration
+enum AUS_StateTimer
+{
+    NONE = 0,
+    SPIN_UP = 1,
+    FIRING_DELAY = 2,
+    SPIN_DOWN = 3
+}
+
+// Spin speed over a state
+enum AUS_StateOutput
+{
+    STOPPED = 0,    // 0
+    RISING = 1,     // Spin-up curve over the state's duration
+    FULL = 2,       // 1
+    FALLING = 3     // Spin-down curve over the state's duration
+}
+
+// Transition table for one weapon cycle, evaluated by AUS_MinigunStateMachine.
+// States are the AUS_BarrelSpinState values. Every state has a timer and an output, and one table
+// entry per combination of inputs (firing intent, state timer run out), so a tick looks up its
+// transition with a single index instead of walking a switch. Entries can be guarded by the trigger
+// dead zone. Tables are built once per cycle and shared.
+class AUS_WeaponStateTable
+{
+    static const int STATE_COUNT = 5;
+    
+    // Input bits of a table index: state * INPUT_COUNT + inputs
+    static const int INPUT_COUNT = 4;
+    static const int INPUT_FIRING = 1;
+    static const int INPUT_EXPIRED = 2;
+    
+    // Conditions for AddTransition
+    static const int ANY = -1;
+    static const int RELEASED = 0;
+    static const int FIRING = 1;
+    static const int RUNNING = 0;
+    static const int EXPIRED = 1;
+    
+    // Table entry for inputs that keep the current state
+    static const int STAY = -1;
+    
+    private static ref array<ref AUS_WeaponStateTable> s_aTables = {};
+    
+    private AUS_WeaponCycle m_eCycle;
+    private ref array<int> m_aTimer = {};
+    private ref array<int> m_aOutput = {};
+    private ref array<int> m_aNextState = {};
+    private ref array<bool> m_aDeadZoneGuard = {};
+    
+    //------------------------------------------------------------------------------------------------
+    void AUS_WeaponStateTable(AUS_WeaponCycle cycle)
+    {
+        m_eCycle = cycle;
+        
+        for (int state = 0; state < STATE_COUNT; state++)
+        {
+            m_aTimer.Insert(AUS_StateTimer.NONE);
+            m_aOutput.Insert(AUS_StateOutput.STOPPED);
+        }
+        
+        for (int index = 0; index < STATE_COUNT * INPUT_COUNT; index++)
+        {
+            m_aNextState.Insert(STAY);
+            m_aDeadZoneGuard.Insert(false);
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Shared table of a cycle, built on first use
+    static AUS_WeaponStateTable Get(AUS_WeaponCycle cycle)
+    {
+        foreach (AUS_WeaponStateTable table : s_aTables)
+        {
+            if (table.m_eCycle == cycle)
+                return table;
+        }
+        
+        AUS_WeaponStateTable table;
+        if (cycle == AUS_WeaponCycle.M230_MOTOR)
+            table = CreateM230Motor();
+        else
+            table = CreateM134Spin();
+        
+        s_aTables.Insert(table);
+        return table;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    private static AUS_WeaponStateTable CreateM134Spin()
+    {
+        AUS_WeaponStateTable table = new AUS_WeaponStateTable(AUS_WeaponCycle.M134_SPIN);
+        table.SetState(AUS_BarrelSpinState.IDLE, AUS_StateTimer.NONE, AUS_StateOutput.STOPPED);
+        table.SetState(AUS_BarrelSpinState.SPIN_UP, AUS_StateTimer.SPIN_UP, AUS_StateOutput.RISING);
+        table.SetState(AUS_BarrelSpinState.READY_TO_FIRE, AUS_StateTimer.FIRING_DELAY, AUS_StateOutput.FULL);
+        table.SetState(AUS_BarrelSpinState.FIRING, AUS_StateTimer.NONE, AUS_StateOutput.FULL);
+        table.SetState(AUS_BarrelSpinState.SPIN_DOWN, AUS_StateTimer.SPIN_DOWN, AUS_StateOutput.FALLING);
+        
+        table.AddTransition(AUS_BarrelSpinState.IDLE, ANY, FIRING, AUS_BarrelSpinState.SPIN_UP);
+        
+        // A tap still finishes spinning up before it spins down
+        table.AddTransition(AUS_BarrelSpinState.SPIN_UP, EXPIRED, FIRING, AUS_BarrelSpinState.READY_TO_FIRE);
+        table.AddTransition(AUS_BarrelSpinState.SPIN_UP, EXPIRED, RELEASED, AUS_BarrelSpinState.SPIN_DOWN);
+        
+        table.AddTransition(AUS_BarrelSpinState.READY_TO_FIRE, EXPIRED, FIRING, AUS_BarrelSpinState.FIRING);
+        table.AddTransition(AUS_BarrelSpinState.READY_TO_FIRE, EXPIRED, RELEASED, AUS_BarrelSpinState.SPIN_DOWN);
+        table.AddTransition(AUS_BarrelSpinState.READY_TO_FIRE, RUNNING, RELEASED, AUS_BarrelSpinState.SPIN_DOWN, true);
+        
+        table.AddTransition(AUS_BarrelSpinState.FIRING, ANY, RELEASED, AUS_BarrelSpinState.SPIN_DOWN);
+        
+        table.AddTransition(AUS_BarrelSpinState.SPIN_DOWN, EXPIRED, ANY, AUS_BarrelSpinState.IDLE);
+        table.AddTransition(AUS_BarrelSpinState.SPIN_DOWN, RUNNING, FIRING, AUS_BarrelSpinState.SPIN_UP, true);
+        
+        return table;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // The motor starts the bolt cycling and fires as soon as it is up to speed. Releasing the
+    // trigger lets the bolt run down, pressing again restarts the motor straight away.
+    private static AUS_WeaponStateTable CreateM230Motor()
+    {
+        AUS_WeaponStateTable table = new AUS_WeaponStateTable(AUS_WeaponCycle.M230_MOTOR);
+        table.SetState(AUS_BarrelSpinState.IDLE, AUS_StateTimer.NONE, AUS_StateOutput.STOPPED);
+        table.SetState(AUS_BarrelSpinState.SPIN_UP, AUS_StateTimer.SPIN_UP, AUS_StateOutput.RISING);
+        table.SetState(AUS_BarrelSpinState.FIRING, AUS_StateTimer.NONE, AUS_StateOutput.FULL);
+        table.SetState(AUS_BarrelSpinState.SPIN_DOWN, AUS_StateTimer.SPIN_DOWN, AUS_StateOutput.FALLING);
+        
+        table.AddTransition(AUS_BarrelSpinState.IDLE, ANY, FIRING, AUS_BarrelSpinState.SPIN_UP);
+        
+        table.AddTransition(AUS_BarrelSpinState.SPIN_UP, EXPIRED, FIRING, AUS_BarrelSpinState.FIRING);
+        table.AddTransition(AUS_BarrelSpinState.SPIN_UP, EXPIRED, RELEASED, AUS_BarrelSpinState.SPIN_DOWN);
+        
+        table.AddTransition(AUS_BarrelSpinState.FIRING, ANY, RELEASED, AUS_BarrelSpinState.SPIN_DOWN);
+        
+        table.AddTransition(AUS_BarrelSpinState.SPIN_DOWN, EXPIRED, ANY, AUS_BarrelSpinState.IDLE);
+        table.AddTransition(AUS_BarrelSpinState.SPIN_DOWN, RUNNING, FIRING, AUS_BarrelSpinState.SPIN_UP);
+        
+        return table;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    void SetState(AUS_BarrelSpinState state, AUS_StateTimer timer, AUS_StateOutput output)
+    {
+        m_aTimer[state] = timer;
+        m_aOutput[state] = output;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Fills every entry of the state matching the conditions (ANY, RUNNING/EXPIRED, RELEASED/FIRING)
+    // that no earlier transition has taken, so transitions added first win
+    void AddTransition(AUS_BarrelSpinState from, int timer, int firing, AUS_BarrelSpinState to, bool deadZoneGuard = false)
+    {
+        for (int inputs = 0; inputs < INPUT_COUNT; inputs++)
+        {
+            if (firing != ANY && (inputs & INPUT_FIRING) != firing * INPUT_FIRING)
+                continue;
+            
+            if (timer != ANY && (inputs & INPUT_EXPIRED) != timer * INPUT_EXPIRED)
+                continue;
+            
+            int index = from * INPUT_COUNT + inputs;
+            if (m_aNextState[index] != STAY)
+                continue;
+            
+            m_aNextState[index] = to;
+            m_aDeadZoneGuard[index] = deadZoneGuard;
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // STAY when the inputs keep the state
+    int GetNextState(int index)
+    {
+        return m_aNextState[index];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // True if the transition is held back while the trigger dead zone runs
+    bool IsDeadZoneGuarded(int index)
+    {
+        return m_aDeadZoneGuard[index];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_StateTimer GetTimer(AUS_BarrelSpinState state)
+    {
+        return m_aTimer[state];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_StateOutput GetOutput(AUS_BarrelSpinState state)
+    {
+        return m_aOutput[state];
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    AUS_WeaponCycle GetCycle()
+    {
+        return m_eCycle;
+    }
+}
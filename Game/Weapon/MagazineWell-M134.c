@@ -1,17 +1,99 @@
 // NATO - AUSSIE MH60
 
+// Belt-fed magazine well. The belt is its magazine's ammo count plus a repeating round pattern;
+// the round at any belt position is computed from the pattern instead of being stored, so a
+// 4,000 round belt costs the same as a 100 round one. See AUS_BeltFeedComponent for the position.
+class AUS_BeltMagazineWellClass {}
+AUS_BeltMagazineWellClass AUS_BeltMagazineWellSource;
+
+class AUS_BeltMagazineWell : BaseMagazineWell
+{
+    //------------------------------------------------------------------------------------------------
+    // Rounds in one repeat of the pattern
+    int GetPatternLength()
+    {
+        return 1;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Round at a position within one repeat of the pattern
+    AUS_BeltRoundType GetPatternRound(int patternIndex)
+    {
+        return AUS_BeltRoundType.BALL;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Round at any position on the belt, 0 being the first round fed
+    AUS_BeltRoundType GetRoundType(int beltPosition)
+    {
+        return GetPatternRound(beltPosition % GetPatternLength());
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    // Rounds of a type among the count rounds fed from firstPosition on, without walking them one by one
+    int CountRounds(AUS_BeltRoundType roundType, int firstPosition, int count)
+    {
+        int patternLength = GetPatternLength();
+        int perPattern = 0;
+        for (int i = 0; i < patternLength; i++)
+        {
+            if (GetPatternRound(i) == roundType)
+                perPattern++;
+        }
+        
+        int total = (count / patternLength) * perPattern;
+        int remainder = count % patternLength;
+        for (int i = 0; i < remainder; i++)
+        {
+            if (GetRoundType(firstPosition + i) == roundType)
+                total++;
+        }
+        
+        return total;
+    }
+}
+
+enum AUS_BeltRoundType
+{
+    BALL = 0,
+    TRACER = 1,
+    ARMOR_PIERCING = 2,
+    HIGH_EXPLOSIVE = 3
+}
+
 //AUSSIE M134 - 7.62x51mm
 class MagazineWellAUSM134Class {}
 MagazineWellAUSM134Class MagazineWellAUSM134Source;
 
-class MagazineWellAUSM134 : BaseMagazineWell
+// Four ball, one tracer
+class MagazineWellAUSM134 : AUS_BeltMagazineWell
 {
+    //------------------------------------------------------------------------------------------------
+    override int GetPatternLength()
+    {
+        return 5;
+    }
+    
+    //------------------------------------------------------------------------------------------------
+    override AUS_BeltRoundType GetPatternRound(int patternIndex)
+    {
+        if (patternIndex == 4)
+            return AUS_BeltRoundType.TRACER;
+        
+        return AUS_BeltRoundType.BALL;
+    }
 };
 	//AUSSIE M230 - 30x113mm	
 class MagazineWellAUS_M230Class {}
 MagazineWellAUS_M230Class MagazineWellAUS_M230Source;
 	
-class MagazineWellAUS_M230 : BaseMagazineWell
+// HEDP throughout
+class MagazineWellAUS_M230 : AUS_BeltMagazineWell
 
 {
-};
\ No newline at end of file
+    //------------------------------------------------------------------------------------------------
+    override AUS_BeltRoundType GetPatternRound(int patternIndex)
+    {
+        return AUS_BeltRoundType.HIGH_EXPLOSIVE;
+    }
+};